@@ -0,0 +1,140 @@
+/*
+ * Host-native throughput benchmark of the QR123 encoder (x86-64 Linux).
+ *
+ * Built by `make bench` with newlib_host.h in place of newlib.h. qrcode.c is
+ * included directly so that its encoding stages, which are static, can be
+ * timed on their own.
+ *
+ * Usage: ./bench [encodes per version] [GF backend id]
+ *
+ * The backend defaults to the one of the host tools (x86 pshufb, see
+ * qr_gf_x86.c, or LUT when built with HOST_X86=0).
+ *
+ * For each version built in (QR_VER_MAX, see qr_tables.h) at full byte
+ * capacity (17, 32, 53 bytes for V1-V3), it cycles through QR_BENCH_PAYLOADS
+ * random payloads and reports encodes/s and ns/encode of qr_eval +
+ * qr_encode, then the ns per call of each stage, every stage timed in a loop
+ * of its own (n / QR_BENCH_STAGE_DIV calls): eval (template copy),
+ * serialize, RS, place and mask (8 masks scored, best applied), and last
+ * qr_verify of the finished symbol (decoded back from the bitmap), the cost
+ * of validating each symbol.
+ */
+
+#include "qrcode.c"
+
+#include <stdlib.h>
+#include <time.h>
+
+#define QR_BENCH_PAYLOADS 256 // power of 2
+#define QR_BENCH_DEFAULT 1000000
+#define QR_BENCH_STAGE_DIV 16
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static volatile uint32_t _sink; // keeps the timed results alive
+
+static uint8_t _payload[QR_BENCH_PAYLOADS][QR_CHARS_MAX];
+static qr_ctx _ctx[QR_BENCH_PAYLOADS];
+static uint32_t _cw[QR_BENCH_PAYLOADS][QR_CW_WORDS];
+static qr_row _placed[QR_BENCH_PAYLOADS][QR_LINES];
+
+/* ns per iteration of the loop body between the two _now_ns() calls. */
+#define BENCH_LOOP(n, body)                              \
+    ({                                                   \
+        uint64_t _t0 = _now_ns();                        \
+        for (unsigned long i = 0; i < (n); i++) {        \
+            uint k = i & (QR_BENCH_PAYLOADS - 1);        \
+            body;                                        \
+        }                                                \
+        (double) (_now_ns() - _t0) / (n);                \
+    })
+
+static void bench_version(uint ver, unsigned long n)
+{
+    uint len = qr_params_ecl[QR_ECL_L][ver - 1].data - 2 - (ver >= 10);
+    qr_ctx ctx[1];
+    uint32_t buf[QR_CW_WORDS];
+    unsigned long m = n / QR_BENCH_STAGE_DIV + 1;
+
+    for (uint k = 0; k < QR_BENCH_PAYLOADS; k++) {
+        for (uint i = 0; i < len; i++)
+            _payload[k][i] = rand();
+        qr_eval(&_ctx[k], ver, _payload[k], len);
+        _serialize_data(&_ctx[k], _cw[k]);
+        _reed_solomon(&_ctx[k], (uint8_t *) _cw[k]);
+        _place_data(&_ctx[k], (uint8_t *) _cw[k]);
+        memcpy(_placed[k], _ctx[k].bmp, sizeof(_placed[k]));
+    }
+
+    double full = BENCH_LOOP(n, {
+        qr_eval(ctx, ver, _payload[k], len);
+        qr_encode(ctx);
+        _sink ^= (uint32_t) ctx->bmp[k % ctx->size];
+    });
+    double eval = BENCH_LOOP(m, {
+        qr_eval(ctx, ver, _payload[k], len);
+        _sink ^= (uint32_t) ctx->bmp[k % ctx->size];
+    });
+    double ser = BENCH_LOOP(m, {
+        _serialize_data(&_ctx[k], buf);
+        _sink ^= buf[k & 15];
+    });
+    /* The data codewords stay the same, so RS can run in place. */
+    double rs = BENCH_LOOP(m, {
+        _reed_solomon(&_ctx[k], (uint8_t *) _cw[k]);
+        _sink ^= _cw[k][QR_CW_WORDS - 1];
+    });
+    /* Placement only ORs bits in, so repeating it leaves the bitmap as is. */
+    double place = BENCH_LOOP(m, {
+        _place_data(&_ctx[k], (uint8_t *) _cw[k]);
+        _sink ^= (uint32_t) _ctx[k].bmp[k % _ctx[k].size];
+    });
+    /* Masking changes the bitmap: start each call from the unmasked one. */
+    double mask = BENCH_LOOP(m, {
+        memcpy(_ctx[k].bmp, _placed[k], sizeof(_placed[k]));
+        _mask_data(&_ctx[k]);
+        _sink ^= _ctx[k].mask;
+    });
+    /* _ctx[k] now holds the finished symbol of _payload[k]. */
+    unsigned long bad = 0;
+    double verify = BENCH_LOOP(m, { bad += !qr_verify(&_ctx[k]); });
+    if (bad)
+        fprintf(stderr, "V%u: %lu symbols failed qr_verify\n", ver, bad);
+
+    printf("V%-2u %5u %12.0f %10.1f %9.1f %10.1f %9.1f %9.1f %9.1f %9.1f\n",
+           ver, len, 1e9 / full, full, eval, ser, rs, place, mask, verify);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long n = argc > 1 ? strtoul(argv[1], NULL, 0) : QR_BENCH_DEFAULT;
+    const char *name = argc > 2 ? qr_gf_select(strtoul(argv[2], NULL, 0))
+                                : _gf->name;
+
+    if (!n || !name) {
+        fprintf(stderr, "usage: %s [encodes per version] [GF backend id]\n",
+                argv[0]);
+        return 1;
+    }
+    printf("%lu encodes per version, GF backend: %s", n, name);
+#if QR_GF_X86
+    if (_gf->rs == qr_rs_x86)
+        printf(" (%s)", qr_gf_x86_kernel());
+#endif
+    printf("\n\n");
+    printf("%-3s %5s %12s %10s %9s %10s %9s %9s %9s %9s\n", "Ver", "Bytes",
+           "encodes/s", "ns/encode", "eval", "serialize", "RS", "place",
+           "mask", "verify");
+    srand(1);
+    uint64_t t0 = _now_ns();
+    for (uint ver = 1; ver <= QR_VER_MAX; ver++)
+        bench_version(ver, n);
+    printf("\nStage columns are ns per call. Total %.2f s\n",
+           (_now_ns() - t0) / 1e9);
+    return 0;
+}
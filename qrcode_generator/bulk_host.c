@@ -0,0 +1,271 @@
+/*
+ * Bulk QR generation on the host (Linux): one symbol per input line,
+ * encoded on a pthread worker pool.
+ *
+ * Built by `make qrbulk` with newlib_host.h in place of newlib.h; qrcode.c
+ * is included directly, as in bench_host.c.
+ *
+ * Usage: ./qrbulk [-t threads] [-s max_threads] [-v] input output
+ *
+ * Each line of input (without its '\n' or "\r\n") is encoded in byte mode at
+ * the smallest version that holds it (V1-V3, up to 53 bytes). output gets
+ * one QR_REC_SIZE-byte record per line, in input order:
+ *
+ *   byte 0       version 1-3, or 0 if the line does not fit in V3
+ *   byte 1       data mask chosen by qr_encode
+ *   bytes 2-3    payload length, little endian
+ *   bytes 4-119  29 row words, little endian, bit 31 - x is column x
+ *                (rows past the symbol size are 0)
+ *   bytes 120-127 zero
+ *
+ * Workers take QR_CHUNK lines at a time from a shared counter, encode them
+ * into their own record slots and pwrite the chunk at its file offset. The
+ * per-thread state (qr_ctx, counters and slots) is cache-line aligned, and
+ * records are two cache lines each, so no two threads write the same line.
+ *
+ * -s N runs the whole job with 1, 2, ... N threads and prints the time and
+ * speedup of each; the output is rewritten every time with the same bytes.
+ *
+ * -v decodes every symbol back from its bitmap right after encoding it
+ * (qr_verify) and reports the ones that do not round-trip; the exit status is
+ * then 2.
+ */
+
+#include "qrcode.c"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define QR_CACHE_LINE 64
+#define QR_REC_SIZE 128 // record bytes, 2 cache lines
+#define QR_CHUNK 256    // lines per work item
+#define QR_THREADS_MAX 64
+
+typedef struct qr_rec {
+    uint8_t ver;
+    uint8_t mask;
+    uint8_t len[2];
+    uint32_t rows[29];
+    uint8_t pad[QR_REC_SIZE - 4 - 4 * 29];
+} qr_rec;
+
+typedef struct qr_worker {
+    _Alignas(QR_CACHE_LINE) qr_ctx ctx;
+    _Alignas(QR_CACHE_LINE) pthread_t tid;
+    unsigned long done;    // symbols encoded
+    unsigned long toolong; // lines over the V3 capacity
+    unsigned long bad;     // symbols failing qr_verify (-v)
+    int err;               // errno of a failed pwrite, else 0
+    _Alignas(QR_CACHE_LINE) qr_rec out[QR_CHUNK];
+} qr_worker;
+
+/* The job, shared read-only by the workers except for next. */
+static const char *_text;       // input file contents
+static const uint32_t *_line;   // start offset of each line
+static const uint16_t *_len;    // length of each line
+static unsigned long _nlines;
+static int _fd;
+static bool _verify;
+static _Alignas(QR_CACHE_LINE) unsigned long _next; // next chunk to encode
+
+static void _encode_line(qr_ctx *ctx, qr_rec *rec, unsigned long i)
+{
+    const uint8_t *data = (const uint8_t *) _text + _line[i];
+    uint len = _len[i];
+    uint ver = 1;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->len[0] = len;
+    rec->len[1] = len >> 8;
+    while (ver <= 3 && !qr_eval(ctx, ver, data, len))
+        ver++;
+    if (ver > 3)
+        return;
+    qr_encode(ctx);
+    rec->ver = ver;
+    rec->mask = ctx->mask;
+    for (uint y = 0; y < ctx->size; y++) {
+        uint32_t w = ctx->bmp[y] >> (QR_ROW_BITS - 32);
+        uint8_t *p = (uint8_t *) &rec->rows[y];
+        p[0] = w;
+        p[1] = w >> 8;
+        p[2] = w >> 16;
+        p[3] = w >> 24;
+    }
+}
+
+static void *_worker(void *arg)
+{
+    qr_worker *w = arg;
+
+    for (;;) {
+        unsigned long first =
+            __atomic_fetch_add(&_next, QR_CHUNK, __ATOMIC_RELAXED);
+        if (first >= _nlines)
+            break;
+        unsigned long n = _nlines - first < QR_CHUNK ? _nlines - first
+                                                      : QR_CHUNK;
+        for (unsigned long i = 0; i < n; i++) {
+            _encode_line(&w->ctx, &w->out[i], first + i);
+            if (!w->out[i].ver)
+                w->toolong++;
+            else if (_verify && !qr_verify(&w->ctx))
+                w->bad++;
+            else
+                w->done++;
+        }
+        size_t bytes = n * sizeof(qr_rec);
+        off_t off = (off_t) first * sizeof(qr_rec);
+        if (pwrite(_fd, w->out, bytes, off) != (ssize_t) bytes) {
+            w->err = errno ? errno : EIO;
+            break;
+        }
+    }
+    return NULL;
+}
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Encode the whole input with nthreads workers, return the seconds taken. */
+static double _run(qr_worker *w, uint nthreads, unsigned long *done,
+                   unsigned long *toolong, unsigned long *bad)
+{
+    double t0 = _now();
+
+    _next = 0;
+    for (uint t = 0; t < nthreads; t++) {
+        w[t].done = w[t].toolong = w[t].bad = 0;
+        w[t].err = 0;
+        if (pthread_create(&w[t].tid, NULL, _worker, &w[t])) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    *done = *toolong = *bad = 0;
+    for (uint t = 0; t < nthreads; t++) {
+        pthread_join(w[t].tid, NULL);
+        if (w[t].err) {
+            errno = w[t].err;
+            perror("pwrite");
+            exit(1);
+        }
+        *done += w[t].done;
+        *toolong += w[t].toolong;
+        *bad += w[t].bad;
+    }
+    return _now() - t0;
+}
+
+/* Read the input and index its lines. */
+static void _load(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    struct stat st;
+    if (!f || fstat(fileno(f), &st)) {
+        perror(path);
+        exit(1);
+    }
+    char *text = malloc(st.st_size + 1);
+    if (!text || fread(text, 1, st.st_size, f) != (size_t) st.st_size) {
+        perror(path);
+        exit(1);
+    }
+    fclose(f);
+    text[st.st_size] = '\n';
+
+    unsigned long n = 0;
+    for (off_t i = 0; i < st.st_size; i++)
+        n += text[i] == '\n';
+    if (st.st_size && text[st.st_size - 1] != '\n')
+        n++; // last line without a newline
+    uint32_t *line = malloc((n + 1) * sizeof(*line));
+    uint16_t *len = malloc((n + 1) * sizeof(*len));
+    if (!line || !len) {
+        perror("malloc");
+        exit(1);
+    }
+
+    const char *p = text, *end = text + st.st_size;
+    for (unsigned long i = 0; i < n; i++) {
+        const char *e = memchr(p, '\n', end - p + 1);
+        size_t l = e - p;
+        if (l && p[l - 1] == '\r')
+            l--;
+        line[i] = p - text;
+        len[i] = l > 0xFFFF ? 0xFFFF : l; // too long for V3 either way
+        p = e + 1;
+    }
+    _text = text;
+    _line = line;
+    _len = len;
+    _nlines = n;
+}
+
+int main(int argc, char **argv)
+{
+    uint nthreads = sysconf(_SC_NPROCESSORS_ONLN), scale = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:v")) != -1) {
+        if (opt == 't')
+            nthreads = strtoul(optarg, NULL, 0);
+        else if (opt == 's')
+            scale = strtoul(optarg, NULL, 0);
+        else if (opt == 'v')
+            _verify = true;
+        else
+            nthreads = 0;
+    }
+    if (argc - optind != 2 || !nthreads || nthreads > QR_THREADS_MAX ||
+        scale > QR_THREADS_MAX) {
+        fprintf(stderr,
+                "usage: %s [-t threads] [-s max_threads] [-v] input output\n",
+                argv[0]);
+        return 1;
+    }
+
+    _load(argv[optind]);
+    _fd = open(argv[optind + 1], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (_fd < 0 || ftruncate(_fd, (off_t) _nlines * sizeof(qr_rec))) {
+        perror(argv[optind + 1]);
+        return 1;
+    }
+    uint nw = scale > nthreads ? scale : nthreads;
+    qr_worker *w = aligned_alloc(QR_CACHE_LINE, nw * sizeof(qr_worker));
+    if (!w) {
+        perror("aligned_alloc");
+        return 1;
+    }
+
+    unsigned long done, toolong, bad;
+    if (!scale) {
+        double s = _run(w, nthreads, &done, &toolong, &bad);
+        printf("%lu symbols (%lu lines too long) in %.3f s with %u threads: "
+               "%.0f symbols/s\n",
+               done, toolong, s, nthreads, _nlines / s);
+    } else {
+        double base = 0;
+        printf("%lu lines\nThreads      Time   Symbols/s  Speedup\n", _nlines);
+        for (uint t = 1; t <= scale; t++) {
+            double s = _run(w, t, &done, &toolong, &bad);
+            if (t == 1)
+                base = s;
+            printf("%7u %8.3fs %11.0f %7.2fx\n", t, s, _nlines / s, base / s);
+        }
+        if (toolong)
+            printf("%lu lines too long for V3\n", toolong);
+    }
+    if (_verify)
+        printf("%lu symbols verified, %lu failed\n", done, bad);
+    close(_fd);
+    return bad ? 2 : 0;
+}
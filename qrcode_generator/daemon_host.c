@@ -0,0 +1,390 @@
+/*
+ * Local QR encoding daemon (Linux): qr_encode behind a Unix stream socket,
+ * with requests grouped into micro-batches.
+ *
+ * Built by `make qrd` with newlib_host.h in place of newlib.h and
+ * _GNU_SOURCE (for ppoll); qrcode.c is included directly, as in
+ * bench_host.c. Wire format: qrd_proto.h.
+ *
+ * Usage: ./qrd [-b batch] [-d deadline_us] [socket]
+ *
+ * A single thread polls the listening socket and the clients. Encode
+ * requests are queued; the queue is encoded as one batch once it holds
+ * `batch` requests, or `deadline_us` after its oldest request arrived,
+ * whichever comes first. A batch is grouped by version, and a group of at
+ * least QRD_SLICE_MIN symbols goes through qr_encode_many, whose bit-sliced
+ * ECC pass covers up to 32 symbols for the cost of one; smaller groups are
+ * encoded one by one. Only then are the replies written. With the x86
+ * pshufb kernels (SSSE3 or AVX2), the ECC of one symbol costs less than a
+ * bit-sliced lane, so every symbol is encoded with qr_encode and a batch
+ * only defers the replies. QRD_BATCH requests change the batch size on the
+ * fly (see load_host.c).
+ *
+ * Client sockets are non-blocking. Replies go to a per-client output queue
+ * that is drained on POLLOUT, so a client that stops reading only stalls
+ * itself: once it has QRD_OUT_MAX replies pending, its requests are left
+ * unread until the queue drains.
+ */
+
+#include "qrcode.c"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+
+#include "qrd_proto.h"
+
+#define QRD_CLIENTS_MAX 256
+#define QRD_BATCH_MAX 255
+#define QRD_FRAME_MAX (2 + 255)
+#define QRD_OUT_MAX 64 // replies pending per client, queued or being encoded
+#define QRD_SLICE_MIN (QR_LANES / 2) // LUT ECC of 16 symbols ~ one pass
+
+typedef struct qrd_client {
+    int fd;           // -1 if the slot is free
+    uint gen;         // bumped on close, so queued replies can be dropped
+    uint have;        // bytes in buf
+    uint jobs;        // requests of this client in _queue
+    uint sent, out;   // obuf[sent..out) is still to be sent
+    uint8_t buf[QRD_FRAME_MAX];
+    uint8_t obuf[QRD_OUT_MAX * sizeof(qrd_reply)];
+} qrd_client;
+
+typedef struct qrd_job {
+    uint16_t client;
+    uint gen;
+    uint8_t len;
+    uint8_t data[53];
+} qrd_job;
+
+static struct pollfd _pfd[1 + QRD_CLIENTS_MAX]; // [0] is the listener
+static qrd_client _client[QRD_CLIENTS_MAX];
+static qrd_job _queue[QRD_BATCH_MAX];
+static qr_ctx _ctx[QRD_BATCH_MAX];
+static uint _nqueue, _batch = 16, _slice_min = QRD_SLICE_MIN;
+static uint64_t _oldest, _deadline = 200000; // ns
+static unsigned long _nbatches, _nencoded;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void _close(uint c)
+{
+    close(_client[c].fd);
+    _client[c].fd = -1;
+    _client[c].gen++;
+    _pfd[1 + c].fd = -1;
+}
+
+/* Replies client c can still take: queued requests count as replies. */
+static uint _room(uint c)
+{
+    const qrd_client *cl = &_client[c];
+    uint out = (cl->out - cl->sent + sizeof(qrd_reply) - 1) / sizeof(qrd_reply);
+    return QRD_OUT_MAX - cl->jobs - out;
+}
+
+/* Send what the output queue of client c holds, without blocking. Return
+ * false if the client was closed. */
+static bool _drain(uint c)
+{
+    qrd_client *cl = &_client[c];
+
+    while (cl->sent < cl->out) {
+        ssize_t n = send(cl->fd, cl->obuf + cl->sent, cl->out - cl->sent,
+                         MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (n <= 0) {
+            _close(c);
+            return false;
+        }
+        cl->sent += n;
+    }
+    if (cl->sent == cl->out)
+        cl->sent = cl->out = 0;
+    if (cl->out)
+        _pfd[1 + c].events |= POLLOUT;
+    else
+        _pfd[1 + c].events &= ~POLLOUT;
+    return true;
+}
+
+/* Queue reply r to client c, which has room for it (see _room). */
+static void _send(uint c, const qrd_reply *r)
+{
+    qrd_client *cl = &_client[c];
+
+    if (cl->fd < 0)
+        return;
+    if (cl->out + sizeof(*r) > sizeof(cl->obuf)) {
+        memmove(cl->obuf, cl->obuf + cl->sent, cl->out - cl->sent);
+        cl->out -= cl->sent;
+        cl->sent = 0;
+    }
+    memcpy(cl->obuf + cl->out, r, sizeof(*r));
+    cl->out += sizeof(*r);
+    _drain(c);
+}
+
+/* Smallest version whose byte capacity holds len, or 0. */
+static uint _version(uint len)
+{
+    for (uint ver = 1; ver <= 3; ver++)
+        if (len + 2 <= qr_params_ecl[QR_ECL_L][ver - 1].data)
+            return ver;
+    return 0;
+}
+
+/*
+ * Encode the queue grouped by version, each group with one qr_encode_many
+ * call if it is large enough, then send the replies in queue order.
+ */
+static void _flush(void)
+{
+    uint8_t ver[QRD_BATCH_MAX];
+    uint8_t slot[QRD_BATCH_MAX]; // context of each job
+    uint start[5] = {0};         // contexts of version v: start[v]..start[v+1]
+
+    if (!_nqueue)
+        return;
+    for (uint i = 0; i < _nqueue; i++) {
+        ver[i] = _version(_queue[i].len);
+        start[ver[i] + 1]++;
+    }
+    for (uint v = 1; v < 5; v++)
+        start[v] += start[v - 1];
+    for (uint i = 0; i < _nqueue; i++) {
+        qrd_job *j = &_queue[i];
+        slot[i] = start[ver[i]]++;
+        if (ver[i])
+            qr_eval(&_ctx[slot[i]], ver[i], j->data, j->len);
+    }
+    /* start[v] is now where version v + 1 begins. */
+    for (uint v = 1; v <= 3; v++) {
+        uint n = start[v] - start[v - 1];
+        if (n >= _slice_min) {
+            qr_encode_many(_ctx + start[v - 1], n);
+            continue;
+        }
+        for (uint i = start[v - 1]; i < start[v]; i++)
+            qr_encode(&_ctx[i]);
+    }
+
+    for (uint i = 0; i < _nqueue; i++) {
+        qrd_job *j = &_queue[i];
+        const qr_ctx *ctx = &_ctx[slot[i]];
+        qrd_reply r = {.status = QRD_OK, .ver = ver[i], .len = j->len};
+
+        if (_client[j->client].gen != j->gen)
+            continue;
+        _client[j->client].jobs--;
+        if (!ver[i]) {
+            r.status = QRD_TOOLONG;
+        } else {
+            r.mask = ctx->mask;
+            for (uint y = 0; y < ctx->size; y++)
+                r.rows[y] = ctx->bmp[y] >> (QR_ROW_BITS - 32);
+        }
+        _send(j->client, &r);
+    }
+    _nbatches++;
+    _nencoded += _nqueue;
+    _nqueue = 0;
+}
+
+/* Handle one complete request of client c, return its size or 0. */
+static uint _request(uint c, const uint8_t *p, uint have)
+{
+    if (have < 2 || have < 2u + (p[0] == QRD_ENCODE ? p[1] : 0))
+        return 0;
+
+    if (p[0] != QRD_ENCODE) {
+        qrd_reply r = {.status = QRD_BADREQ, .len = p[1]};
+        _flush(); // replies go out in request order
+        if (p[0] == QRD_BATCH && p[1]) {
+            _batch = p[1];
+            r.status = QRD_OK;
+        }
+        _send(c, &r);
+        return 2;
+    }
+
+    qrd_job *j = &_queue[_nqueue];
+    if (!_nqueue)
+        _oldest = _now_ns();
+    j->client = c;
+    j->gen = _client[c].gen;
+    _client[c].jobs++;
+    j->len = p[1];
+    memcpy(j->data, p + 2, p[1] < 53 ? p[1] : 53); // longer ones fail anyway
+    if (++_nqueue >= _batch)
+        _flush();
+    return 2 + p[1];
+}
+
+/*
+ * Take the complete requests in the input buffer of client c while it has
+ * room for their replies; read more only once that room is there.
+ */
+static void _parse(uint c)
+{
+    qrd_client *cl = &_client[c];
+    uint used = 0, k;
+
+    while (cl->fd >= 0 && _room(c) &&
+           (k = _request(c, cl->buf + used, cl->have - used)))
+        used += k;
+    if (cl->fd < 0)
+        return;
+    memmove(cl->buf, cl->buf + used, cl->have - used);
+    cl->have -= used;
+    if (_room(c))
+        _pfd[1 + c].events |= POLLIN;
+    else
+        _pfd[1 + c].events &= ~POLLIN;
+}
+
+static void _readable(uint c)
+{
+    qrd_client *cl = &_client[c];
+    ssize_t n = read(cl->fd, cl->buf + cl->have, sizeof(cl->buf) - cl->have);
+
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return;
+    if (n <= 0) {
+        _close(c);
+        return;
+    }
+    cl->have += n;
+    _parse(c);
+}
+
+/* The output queue of client c drained some: take the requests it held. */
+static void _writable(uint c)
+{
+    if (_drain(c))
+        _parse(c);
+}
+
+static void _accept(void)
+{
+    int fd = accept4(_pfd[0].fd, NULL, NULL, SOCK_NONBLOCK);
+    if (fd < 0)
+        return;
+    for (uint c = 0; c < QRD_CLIENTS_MAX; c++) {
+        if (_client[c].fd < 0) {
+            _client[c].fd = fd;
+            _client[c].have = _client[c].jobs = 0;
+            _client[c].sent = _client[c].out = 0;
+            _pfd[1 + c].fd = fd;
+            _pfd[1 + c].events = POLLIN;
+            return;
+        }
+    }
+    close(fd); // full
+}
+
+static volatile sig_atomic_t _quit;
+
+static void _on_signal(int sig)
+{
+    (void) sig;
+    _quit = 1;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = QRD_SOCKET;
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:d:")) != -1) {
+        if (opt == 'b')
+            _batch = strtoul(optarg, NULL, 0);
+        else if (opt == 'd')
+            _deadline = strtoull(optarg, NULL, 0) * 1000;
+        else
+            _batch = 0;
+    }
+    if (optind < argc)
+        path = argv[optind];
+    if (!_batch || _batch > QRD_BATCH_MAX ||
+        strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "usage: %s [-b batch] [-d deadline_us] [socket]\n",
+                argv[0]);
+        return 1;
+    }
+
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0 || bind(lfd, (struct sockaddr *) &addr, sizeof(addr)) ||
+        listen(lfd, 64)) {
+        perror(path);
+        return 1;
+    }
+    signal(SIGINT, _on_signal);
+    signal(SIGTERM, _on_signal);
+
+    _pfd[0].fd = lfd;
+    _pfd[0].events = POLLIN;
+    for (uint c = 0; c < QRD_CLIENTS_MAX; c++) {
+        _client[c].fd = -1;
+        _pfd[1 + c].fd = -1;
+    }
+#if QR_GF_X86
+    if (_gf->rs == qr_rs_x86 && strcmp(qr_gf_x86_kernel(), "LUT"))
+        _slice_min = QRD_BATCH_MAX + 1; // never
+#endif
+    printf("qrd: %s, batch %u, deadline %lu us, ECC %s\n", path, _batch,
+           (unsigned long) (_deadline / 1000),
+           _slice_min > QRD_BATCH_MAX ? "per symbol" : "bit-sliced");
+    fflush(stdout);
+
+    while (!_quit) {
+        struct timespec ts, *tp = NULL;
+        if (_nqueue) {
+            uint64_t now = _now_ns(), due = _oldest + _deadline;
+            uint64_t left = due > now ? due - now : 0;
+            ts.tv_sec = left / 1000000000u;
+            ts.tv_nsec = left % 1000000000u;
+            tp = &ts;
+        }
+        int n = ppoll(_pfd, 1 + QRD_CLIENTS_MAX, tp, NULL);
+        if (n < 0 && errno != EINTR)
+            break;
+        if (n > 0) {
+            if (_pfd[0].revents & POLLIN)
+                _accept();
+            for (uint c = 0; c < QRD_CLIENTS_MAX; c++) {
+                short ev = _pfd[1 + c].revents;
+                if (_pfd[1 + c].fd < 0 || !ev)
+                    continue;
+                if (ev & POLLOUT)
+                    _writable(c);
+                if (_client[c].fd < 0)
+                    continue;
+                if (ev & POLLIN)
+                    _readable(c);
+                else if (ev & (POLLERR | POLLHUP))
+                    _close(c); // gone, and not read from: nothing to deliver
+            }
+        }
+        if (_nqueue && _now_ns() >= _oldest + _deadline)
+            _flush();
+    }
+
+    printf("qrd: %lu symbols in %lu batches\n", _nencoded, _nbatches);
+    close(lfd);
+    unlink(path);
+    return 0;
+}
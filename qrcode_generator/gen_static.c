@@ -0,0 +1,91 @@
+/*
+ * Host-side symbol generator for the QR123 encoder.
+ *
+ * Runs the encoder itself (qrcode.c, built with newlib_host.h like the other
+ * host tools) on every payload of qr_static.def and emits the finished
+ * bitmaps and their masks as C tables (qr_static.c), so the firmware spends
+ * no encoding cycles on payloads known at build time.
+ *
+ * Build and run on the host (see Makefile):
+ *    gcc -O2 -DQR_VER_MAX=3 -include newlib_host.h -o gen_static \
+ *        gen_static.c qr_gf.c qr_tables.c && ./gen_static > qr_static.c
+ */
+
+#include "qrcode.c"
+
+/* The table this tool generates, empty here: qrcode.c encodes everything. */
+const qr_static qr_static_l[QR_NSTATIC];
+
+static const struct {
+    const char *name;
+    uint ver;
+    const char *str;
+    uint len;
+} _list[] = {
+#define QR_STATIC(name, ver, str) {#name, ver, str, sizeof(str) - 1},
+#include "qr_static.def"
+#undef QR_STATIC
+};
+
+#define QR_NLIST (sizeof(_list) / sizeof(_list[0]))
+
+/* Print len payload bytes as a C string literal. */
+static void _print_str(const char *s, uint len)
+{
+    putchar('"');
+    for (uint i = 0; i < len; i++) {
+        uint8_t c = s[i];
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < 0x20 || c > 0x7E)
+            printf("\\%03o", c);
+        else
+            putchar(c);
+    }
+    putchar('"');
+}
+
+int main(void)
+{
+    qr_ctx ctx[1];
+    uint8_t mask[QR_NLIST];
+
+    printf("/* Generated by gen_static.c from qr_static.def -- do not edit. */"
+           "\n\n");
+    printf("#include \"qr_static.h\"\n\n");
+    printf("#if QR_VER_MAX != %u\n", QR_VER_MAX);
+    printf("#error \"qr_static.c is for QR_VER_MAX %u, make clean first\"\n",
+           QR_VER_MAX);
+    printf("#endif\n\n");
+
+    for (uint i = 0; i < QR_NLIST; i++) {
+        if (!qr_eval(ctx, _list[i].ver, (const uint8_t *) _list[i].str,
+                     _list[i].len)) {
+            fprintf(stderr, "gen_static: %s does not fit V%u (VER_MAX %u)\n",
+                    _list[i].name, _list[i].ver, QR_VER_MAX);
+            return 1;
+        }
+        qr_encode(ctx);
+        mask[i] = ctx->mask;
+        printf("static const qr_row _bmp_%s[%u] = {", _list[i].name,
+               ctx->size);
+        for (uint y = 0; y < ctx->size; y++) {
+            printf("%s", y % 4 ? " " : "\n    ");
+            if (QR_ROW_BITS == 32)
+                printf("0x%08x,", (uint32_t) ctx->bmp[y]);
+            else
+                printf("0x%016llx,", (unsigned long long) ctx->bmp[y]);
+        }
+        printf("\n};\n\n");
+    }
+
+    printf("const qr_static qr_static_l[QR_NSTATIC] = {\n");
+    for (uint i = 0; i < QR_NLIST; i++) {
+        printf("    {(const uint8_t *) ");
+        _print_str(_list[i].str, _list[i].len);
+        printf(", %u, %u, %u, _bmp_%s},\n", _list[i].len, _list[i].ver,
+               mask[i], _list[i].name);
+    }
+    printf("};\n");
+    return 0;
+}
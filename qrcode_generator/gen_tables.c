@@ -0,0 +1,673 @@
+/*
+ * Host-side table generator for the QR123 encoder.
+ *
+ * Walks the QR zig-zag sequence once per version at build time and emits the
+ * placement runs and data-module masks as C tables (qr_tables.c), so the
+ * firmware never has to run zigzag_step/_is_data. Also pre-renders the
+ * function patterns of each version into a bitmap template, and lays out the
+ * codewords (RS blocks and their interleaving) of each version and level.
+ *
+ * Build and run on the host:
+ *    gcc -O2 -o gen_tables gen_tables.c && ./gen_tables [ver_max] > qr_tables.c
+ *
+ * ver_max (3-10, default 3) must match the QR_VER_MAX the encoder is built
+ * with. Up to V3 the row words are 32 bits wide, past it 64 bits.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef unsigned uint;
+
+#define VER_MAX 10
+
+/* Total codewords (data + ECC) of V1-V10. */
+static const uint _capa[VER_MAX] = {26, 44, 70, 100, 134,
+                                    172, 196, 242, 292, 346};
+
+/* Error correction levels, in the encoder's order (qr_params_ecl). */
+#define ECL_N 4
+static const char _ecl_name[ECL_N] = {'l', 'm', 'q', 'h'};
+
+/* ECC codewords per RS block of V1-V10, levels L, M, Q, H. */
+static const uint _eccdeg[ECL_N][VER_MAX] = {
+    {7, 10, 15, 20, 26, 18, 20, 24, 30, 18},
+    {10, 16, 26, 18, 24, 16, 18, 22, 22, 26},
+    {13, 22, 18, 26, 18, 24, 18, 22, 20, 24},
+    {17, 28, 22, 16, 22, 28, 26, 26, 24, 28},
+};
+
+/* RS blocks of V1-V10, levels L, M, Q, H. The data codewords are split as
+ * evenly as possible, the shorter blocks first. */
+static const uint _nblk[ECL_N][VER_MAX] = {
+    {1, 1, 1, 1, 1, 2, 2, 2, 2, 4},
+    {1, 1, 1, 2, 2, 4, 4, 4, 5, 5},
+    {1, 1, 2, 2, 4, 4, 6, 6, 8, 8},
+    {1, 1, 2, 4, 4, 4, 5, 6, 8, 8},
+};
+
+/* Remainder bits after the last codeword. */
+static const uint _rem[VER_MAX] = {0, 7, 7, 7, 7, 7, 0, 0, 0, 0};
+
+/* Alignment pattern centre coordinates, 0-terminated (none for V1). */
+static const uint8_t _align[VER_MAX][4] = {
+    {0},         {6, 18},     {6, 22},     {6, 26},     {6, 30},
+    {6, 34},     {6, 22, 38}, {6, 24, 42}, {6, 26, 46}, {6, 28, 50},
+};
+
+/* Module x of a row: MSB is column 0. */
+#define BIT(x) (0x8000000000000000ull >> (x))
+
+/* Row word width of the emitted tables, 32 or 64. */
+static uint _width;
+
+/* Function modules of the version being emitted. */
+static uint64_t _func[64];
+
+/* Bit count of each placement run of the version last emitted. */
+static uint8_t _run_n[3000];
+static uint _nruns;
+
+/* Print a row word at the emitted width. */
+static void _print_row(const char *sep, uint64_t r)
+{
+    if (_width == 32)
+        printf("%s0x%08x", sep, (uint32_t) (r >> 32));
+    else
+        printf("%s0x%016llx", sep, (unsigned long long) r);
+}
+
+static void _module(uint64_t A[], uint x, uint y, bool dark)
+{
+    _func[y] |= BIT(x);
+    if (dark)
+        A[y] |= BIT(x);
+}
+
+/* Finder with its separator, top-left module at (x0, y0). */
+static void _finder(uint64_t A[], int x0, int y0, int size)
+{
+    for (int dy = -1; dy <= 7; dy++) {
+        for (int dx = -1; dx <= 7; dx++) {
+            int x = x0 + dx, y = y0 + dy;
+            if (x < 0 || y < 0 || x >= size || y >= size)
+                continue;
+            int ax = dx > 3 ? dx - 3 : 3 - dx, ay = dy > 3 ? dy - 3 : 3 - dy;
+            int d = ax > ay ? ax : ay;
+            _module(A, x, y, d != 2 && d != 4);
+        }
+    }
+}
+
+/*
+ * Put format bits f at both places. Bit 14 is format_string[0].
+ *  - bits 0-7: column 8 of rows 0-5, 7, 8; and row 8 from the right edge.
+ *  - bits 8-14: row 8 at columns 7, 5-0; and column 8 of the bottom 7 rows.
+ */
+static void _format(uint64_t A[], uint size, uint f)
+{
+    for (uint i = 0; i < 15; i++) {
+        bool b = f >> i & 1;
+        if (i < 8) {
+            _module(A, 8, i < 6 ? i : i + 1, b);
+            _module(A, size - 1 - i, 8, b);
+        } else {
+            _module(A, i == 8 ? 7 : 14 - i, 8, b);
+            _module(A, 8, size - 15 + i, b);
+        }
+    }
+}
+
+/*
+ * Draw finders, timing patterns, alignment patterns, the dark dot and the
+ * version information (V7 and up). The format modules are reserved but left
+ * light: the encoder ORs in the word of its level and mask (qr_format_row,
+ * qr_format_col). _func gets every function module, dark or light.
+ */
+static void _init_bmp(uint64_t A[], uint ver)
+{
+    uint size = ver * 4 + 17;
+    const uint8_t *al = _align[ver - 1];
+
+    for (uint y = 0; y < 64; y++)
+        A[y] = _func[y] = 0;
+
+    _finder(A, 0, 0, size);
+    _finder(A, size - 7, 0, size);
+    _finder(A, 0, size - 7, size);
+
+    /* Timing patterns, between the separators. */
+    for (uint i = 8; i < size - 8; i++) {
+        _module(A, i, 6, !(i & 1));
+        _module(A, 6, i, !(i & 1));
+    }
+
+    /* Alignment patterns, except where they would hit a finder. */
+    uint n = 0;
+    while (n < 4 && al[n])
+        n++;
+    for (uint i = 0; i < n; i++) {
+        for (uint j = 0; j < n; j++) {
+            if ((i == 0 && j == 0) || (i == 0 && j == n - 1) ||
+                (i == n - 1 && j == 0))
+                continue;
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    int ax = dx < 0 ? -dx : dx, ay = dy < 0 ? -dy : dy;
+                    _module(A, al[j] + dx, al[i] + dy,
+                            (ax > ay ? ax : ay) != 1);
+                }
+            }
+        }
+    }
+
+    /* Version information: BCH(18, 6), 6x3 blocks by two finders. */
+    if (ver >= 7) {
+        uint rem = ver;
+        for (uint i = 0; i < 12; i++)
+            rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+        uint bits = ver << 12 | rem;
+        for (uint i = 0; i < 18; i++) {
+            bool b = bits >> i & 1;
+            uint a = size - 11 + i % 3;
+            _module(A, a, i / 3, b);
+            _module(A, i / 3, a, b);
+        }
+    }
+
+    /* The dark dot, then the format bits. */
+    _module(A, 8, size - 8, true);
+    _format(A, size, 0);
+}
+
+/*
+ * Return if dot (x,y) is for data (i.e. not function patterns).
+ */
+static bool _is_data(uint x, uint y)
+{
+    return !(_func[y] & BIT(x));
+}
+
+/*
+ * The QR zig-zag sequence generator.
+ *
+ * To iterate through all valid data positions: call with initial x and y =
+ * size-1, feed back the result as input, and repeat the call-feed cycle.
+ */
+static void zigzag_step(uint *px, uint *py, uint size_m1)
+{
+    uint x = *px, y = *py;
+    while (true) {
+        switch ((x - (x > 6)) & 3) {
+        case 0:
+            if (y < size_m1)
+                x += 1, y += 1;
+            else
+                x -= 1;
+            break;
+        case 1:
+            x -= 1;
+            break;
+        case 2:
+            if (y > 0)
+                x += 1, y -= 1;
+            else {
+                x -= 1;
+                if (x == 6)
+                    x = 5;
+            }
+            break;
+        default:
+            x -= 1;
+        }
+        if (_is_data(x, y))
+            break;
+    }
+    *px = x, *py = y;
+}
+
+/*
+ * Emit the placement runs of one version.
+ *
+ * Consecutive data bits that land on neighbouring modules of the same row
+ * (the right-then-left step of the zig-zag) form one run, so the firmware can
+ * OR them into the row word together. The 7 remainder bits of V2-V6 are
+ * always 0 before masking and are left out; the mask pass covers them.
+ */
+static void emit_runs(uint ver)
+{
+    uint size_m1 = ver * 4 + 16;
+    uint nbits = _capa[ver - 1] * 8;
+    uint x = size_m1, y = size_m1;
+    uint nruns = 0;
+
+    printf("static const qr_run _runs_v%u[] = {", ver);
+    for (uint i = 0; i < nbits;) {
+        uint rx = x, ry = y, n = 0;
+        do {
+            n++, i++;
+            if (i < nbits)
+                zigzag_step(&x, &y, size_m1);
+        } while (i < nbits && n < 2 && y == ry && x == rx - n);
+        printf("%s{%2u, %2u, %u, %u},", nruns % 4 ? " " : "\n    ", ry,
+               _width - 1 - rx, n, (1u << n) - 1);
+        _run_n[nruns++] = n;
+    }
+    _nruns = nruns;
+    /* End marker: wants more bits than a codeword can hold. */
+    printf("\n    {0, 0, 9, 0},\n};\n\n");
+}
+
+/*
+ * Emit where each codeword starts in the runs of emit_runs: run index << 1,
+ * plus 1 if its first bit is the second bit of that run.
+ */
+static void emit_cwrun(uint ver)
+{
+    uint ncw = _capa[ver - 1];
+    uint r = 0, start = 0; // run r covers bits [start, start + _run_n[r])
+
+    printf("static const uint16_t _cwrun_v%u[%u] = {", ver, ncw);
+    for (uint i = 0; i < ncw; i++) {
+        while (start + _run_n[r] <= i * 8)
+            start += _run_n[r++];
+        printf("%s%u,", i % 12 ? " " : "\n    ", r << 1 | (i * 8 - start));
+    }
+    printf("\n};\n\n");
+}
+
+/*
+ * Emit the rows of data modules (including remainder bits) of one version.
+ */
+static void emit_datamask(uint ver)
+{
+    uint size_m1 = ver * 4 + 16;
+    uint nbits = _capa[ver - 1] * 8 + _rem[ver - 1];
+    uint64_t mask[64] = {0};
+
+    uint x = size_m1, y = size_m1;
+    for (uint i = 0; i < nbits; i++) {
+        mask[y] |= BIT(x);
+        if (i + 1 < nbits)
+            zigzag_step(&x, &y, size_m1);
+    }
+
+    printf("static const qr_row _datamask_v%u[%u] = {", ver, size_m1 + 1);
+    for (uint i = 0; i <= size_m1; i++)
+        _print_row(i % 4 ? " " : "\n    ", mask[i]), printf(",");
+    printf("\n};\n\n");
+}
+
+/*
+ * Emit the 8 data mask patterns as row words, for row y mod 12.
+ * The patterns repeat every 6 columns and every 12 rows (mask 4 needs y mod 4,
+ * masks 5-7 need y mod 6), so 12 words per mask cover any row.
+ */
+static void emit_maskpat(void)
+{
+    printf("const qr_row qr_maskpat[8][12] = {");
+    for (uint m = 0; m < 8; m++) {
+        printf("\n    {");
+        for (uint y = 0; y < 12; y++) {
+            uint64_t w = 0;
+            for (uint x = 0; x < _width; x++) {
+                uint v;
+                switch (m) {
+                case 0: v = (y + x) % 2; break;
+                case 1: v = y % 2; break;
+                case 2: v = x % 3; break;
+                case 3: v = (y + x) % 3; break;
+                case 4: v = (y / 2 + x / 3) % 2; break;
+                case 5: v = (y * x) % 2 + (y * x) % 3; break;
+                case 6: v = ((y * x) % 2 + (y * x) % 3) % 2; break;
+                default: v = ((y + x) % 2 + (y * x) % 3) % 2; break;
+                }
+                if (v == 0)
+                    w |= BIT(x);
+            }
+            _print_row(y == 0 ? "" : y % 4 ? ", " : ",\n     ", w);
+        }
+        printf("},");
+    }
+    printf("\n};\n\n");
+}
+
+/*
+ * Emit the nibble expansion tables for integer scales 1-8: each bit of the
+ * nibble (MSB first) repeated `scale` times, 4 * scale bits right-aligned.
+ */
+static void emit_expand(void)
+{
+    printf("const uint32_t qr_expand[8][16] = {");
+    for (uint s = 1; s <= 8; s++) {
+        printf("\n    {");
+        for (uint v = 0; v < 16; v++) {
+            uint32_t w = 0;
+            for (uint b = 0; b < 4; b++)
+                for (uint k = 0; k < s; k++)
+                    w = w << 1 | (v >> (3 - b) & 1);
+            printf("%s0x%08x", v == 0 ? "" : v % 4 ? ", " : ",\n     ", w);
+        }
+        printf("},");
+    }
+    printf("\n};\n\n");
+}
+
+/*
+ * Emit the function-pattern template of one version. Also leaves _func set
+ * for the zig-zag walks of that version.
+ */
+static void emit_template(uint ver)
+{
+    uint size = ver * 4 + 17;
+    uint64_t A[64];
+
+    _init_bmp(A, ver);
+    printf("static const qr_row _template_v%u[%u] = {", ver, size);
+    for (uint i = 0; i < size; i++)
+        _print_row(i % 4 ? " " : "\n    ", A[i]), printf(",");
+    printf("\n};\n\n");
+}
+
+static uint gf_mul(uint x, uint y)
+{
+    uint z = 0;
+    for (int i = 7; i >= 0; i--) {
+        z = (z << 1) ^ ((z >> 7) * 0x11D);
+        z ^= ((y >> i) & 1) * x;
+    }
+    return z;
+}
+
+static uint gf_log(uint x)
+{
+    uint k = 0;
+    for (uint a = 1; a != x; a = gf_mul(a, 2))
+        k++;
+    return k;
+}
+
+/*
+ * Generator polynomial of degree deg, leading coefficient (1) first.
+ */
+static void make_gen(uint deg, uint gen[32])
+{
+    gen[0] = 1;
+    for (uint j = 1; j < 32; j++)
+        gen[j] = 0;
+    for (uint i = 0, a = 1; i < deg; i++, a = gf_mul(a, 2))
+        for (uint j = i + 1; j > 0; j--)
+            gen[j] ^= gf_mul(gen[j - 1], a);
+}
+
+/*
+ * Emit the generator coefficients of one version, leading 1 omitted: as
+ * plain values for the value-domain GF backends, and as logs (alpha
+ * exponents) for the LUT one.
+ */
+static void emit_gen(uint deg)
+{
+    uint gen[32];
+
+    make_gen(deg, gen);
+    printf("static const uint8_t _gen_d%u[%u] = {", deg, deg);
+    for (uint j = 1; j <= deg; j++)
+        printf("%s0x%02x", j == 1 ? "" : j % 12 == 1 ? ",\n    " : ", ",
+               gen[j]);
+    printf("};\n\n");
+    printf("static const uint8_t _genlog_d%u[%u] = {", deg, deg);
+    for (uint j = 1; j <= deg; j++)
+        printf("%s%u", j == 1 ? "" : j % 12 == 1 ? ",\n    " : ", ",
+               gf_log(gen[j]));
+    printf("};\n\n");
+}
+
+/*
+ * Emit the generators of every ECC degree used up to ver_max, once each.
+ */
+static void emit_gens(uint ver_max)
+{
+    for (uint deg = 1; deg <= 30; deg++) {
+        bool used = false;
+        for (uint l = 0; l < ECL_N; l++)
+            for (uint ver = 1; ver <= ver_max; ver++)
+                used |= _eccdeg[l][ver - 1] == deg;
+        if (used)
+            emit_gen(deg);
+    }
+}
+
+/*
+ * Emit the codeword order of a version and level with more than one RS
+ * block.
+ *
+ * The encoder keeps the data codewords block after block, then the ECC
+ * codewords block after block. The symbol takes them interleaved: codeword
+ * c of every block (short blocks have no last one), for data then for ECC.
+ * Entry i is the buffer index of the i-th codeword to place.
+ */
+static void emit_perm(uint ver, uint l)
+{
+    uint capa = _capa[ver - 1], deg = _eccdeg[l][ver - 1];
+    uint nblk = _nblk[l][ver - 1], data = capa - deg * nblk;
+    uint dlen = data / nblk, nshort = nblk - data % nblk;
+    uint i = 0;
+
+    printf("static const uint16_t _perm_v%u%c[%u] = {", ver, _ecl_name[l],
+           capa);
+    for (uint c = 0; c <= dlen; c++) {
+        for (uint b = 0; b < nblk; b++) {
+            if (c == dlen && b < nshort)
+                continue;
+            uint start = b * dlen + (b > nshort ? b - nshort : 0);
+            printf("%s%u,", i++ % 12 ? " " : "\n    ", start + c);
+        }
+    }
+    for (uint c = 0; c < deg; c++)
+        for (uint b = 0; b < nblk; b++)
+            printf("%s%u,", i++ % 12 ? " " : "\n    ", data + b * deg + c);
+    printf("\n};\n\n");
+}
+
+/*
+ * Emit the codeword layout of every version up to ver_max, for each level.
+ */
+static void emit_params(uint ver_max)
+{
+    printf("const qr_params qr_params_ecl[4][%u] = {", ver_max);
+    for (uint l = 0; l < ECL_N; l++) {
+        printf("\n    {\n");
+        for (uint ver = 1; ver <= ver_max; ver++) {
+            uint capa = _capa[ver - 1], deg = _eccdeg[l][ver - 1];
+            uint nblk = _nblk[l][ver - 1], data = capa - deg * nblk;
+            printf("        {%u, %u, %u, %u, %u, %u, %u, _genlog_d%u, "
+                   "_gen_d%u, ",
+                   capa, data, deg, nblk, data / nblk, nblk - data % nblk, l,
+                   deg, deg);
+            if (nblk > 1)
+                printf("_perm_v%u%c},\n", ver, _ecl_name[l]);
+            else
+                printf("NULL},\n");
+        }
+        printf("    },");
+    }
+    printf("\n};\n\n");
+}
+
+/*
+ * Emit the ECC of a unit data codeword at each position of one version at
+ * level L:
+ * row i is the remainder of x^(len - 1 - i + deg) by the generator, so by
+ * linearity the ECC of a symbol changes by d * row i when data codeword i
+ * changes by d. Rows are padded to 16 bytes for shift indexing.
+ */
+static void emit_eccunit(uint ver)
+{
+    uint deg = _eccdeg[0][ver - 1];
+    uint len = _capa[ver - 1] - deg;
+    uint gen[32];
+
+    make_gen(deg, gen);
+
+    printf("static const uint8_t _eccunit_v%u[%u][16] = {", ver, len);
+    for (uint i = 0; i < len; i++) {
+        uint res[16] = {0};
+        for (uint k = 0; k < len; k++) {
+            uint factor = (k == i) ^ res[0];
+            for (uint j = 0; j < deg; j++)
+                res[j] = (j + 1 < deg ? res[j + 1] : 0) ^
+                         gf_mul(gen[j + 1], factor);
+        }
+        printf("\n    {");
+        for (uint j = 0; j < deg; j++)
+            printf("%s0x%02x", j ? ", " : "", res[j]);
+        printf("},");
+    }
+    printf("\n};\n\n");
+}
+
+/*
+ * Alphanumeric mode values: 0-9 for the digits, 10-44 for A-Z and " $%*+-./:",
+ * 0xFF for bytes outside the set.
+ */
+static void emit_alnum(void)
+{
+    static const char set[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+    printf("const uint8_t qr_alnum[256] = {");
+    for (uint i = 0; i < 256; i++) {
+        uint v = 0xFF;
+        for (uint k = 0; k < sizeof(set) - 1; k++)
+            if ((uint8_t) set[k] == i)
+                v = k;
+        printf("%s0x%02x,", i % 8 ? " " : "\n    ", v);
+    }
+    printf("\n};\n\n");
+}
+
+/*
+ * Bit reversal of a byte: turns an MSB-first codeword into LSB-first order.
+ */
+static void emit_rev8(void)
+{
+    printf("const uint8_t qr_rev8[256] = {");
+    for (uint i = 0; i < 256; i++) {
+        uint r = 0;
+        for (uint b = 0; b < 8; b++)
+            r |= (i >> b & 1) << (7 - b);
+        printf("%s0x%02x,", i % 8 ? " " : "\n    ", r);
+    }
+    printf("\n};\n\n");
+}
+
+/*
+ * Format word of format data d (level bits << 3 | mask): BCH(15,5) with
+ * generator 10100110111, XORed with 101010000010010.
+ */
+static uint _format_word(uint d)
+{
+    uint r = d << 10;
+    for (int b = 14; b >= 10; b--)
+        if (r >> b & 1)
+            r ^= 0x537 << (b - 10);
+    return (d << 10 | r) ^ 0x5412;
+}
+
+/*
+ * All 32 format words, and the modules of each as OR masks: the column-8
+ * rows (bits 0-8 rows 0-8, bits 9-15 the bottom 7 rows) and, per version,
+ * the row-8 word. Format bit i is at column-8 bit i (i < 6) or i + 1.
+ */
+static void emit_format(uint ver_max)
+{
+    printf("const uint16_t qr_format[32] = {");
+    for (uint d = 0; d < 32; d++)
+        printf("%s0x%04x,", d % 8 ? " " : "\n    ", _format_word(d));
+    printf("\n};\n\n");
+
+    printf("const uint16_t qr_format_col[32] = {");
+    for (uint d = 0; d < 32; d++) {
+        uint f = _format_word(d), col = 0;
+        for (uint i = 0; i < 15; i++)
+            if (f >> i & 1)
+                col |= 1u << (i < 6 ? i : i + 1);
+        printf("%s0x%04x,", d % 8 ? " " : "\n    ", col);
+    }
+    printf("\n};\n\n");
+
+    for (uint ver = 1; ver <= ver_max; ver++) {
+        uint size = ver * 4 + 17;
+        printf("static const qr_row _format_row_v%u[32] = {", ver);
+        for (uint d = 0; d < 32; d++) {
+            uint f = _format_word(d);
+            uint64_t row = 0;
+            for (uint i = 0; i < 15; i++)
+                if (f >> i & 1)
+                    row |= BIT(i < 8 ? size - 1 - i : i == 8 ? 7 : 14 - i);
+            _print_row(d % 4 ? " " : "\n    ", row), printf(",");
+        }
+        printf("\n};\n\n");
+    }
+}
+
+/* Print "const type name[n] = {pfx1, pfx2, ...};" over versions 1-n. */
+static void _print_index(const char *decl, const char *pfx, uint n)
+{
+    printf("%s = {", decl);
+    for (uint ver = 1; ver <= n; ver++)
+        printf("%s%s%u", ver > 1 ? ", " : "", pfx, ver);
+    printf("};\n");
+}
+
+int main(int argc, char **argv)
+{
+    uint ver_max = argc > 1 ? strtoul(argv[1], NULL, 0) : 3;
+    char decl[64];
+
+    if (ver_max < 3 || ver_max > VER_MAX) {
+        fprintf(stderr, "usage: %s [ver_max (3-%u)]\n", argv[0], VER_MAX);
+        return 1;
+    }
+    _width = ver_max > 3 ? 64 : 32;
+
+    printf("/* Generated by gen_tables.c -- do not edit. */\n\n");
+    printf("#include \"qr_tables.h\"\n\n");
+    printf("#if QR_VER_MAX != %u\n", ver_max);
+    printf("#error \"qr_tables.c is for QR_VER_MAX %u, make clean first\"\n",
+           ver_max);
+    printf("#endif\n\n");
+
+    for (uint ver = 1; ver <= ver_max; ver++) {
+        emit_template(ver);
+        emit_runs(ver);
+        if (ver <= 3)
+            emit_cwrun(ver);
+        emit_datamask(ver);
+        for (uint l = 0; l < ECL_N; l++)
+            if (_nblk[l][ver - 1] > 1)
+                emit_perm(ver, l);
+        if (ver <= 3)
+            emit_eccunit(ver);
+    }
+    emit_gens(ver_max);
+    emit_params(ver_max);
+    emit_format(ver_max);
+    emit_maskpat();
+    emit_expand();
+    emit_alnum();
+    emit_rev8();
+
+    sprintf(decl, "const qr_run *const qr_runs[%u]", ver_max);
+    _print_index(decl, "_runs_v", ver_max);
+    _print_index("const uint16_t *const qr_cwrun[3]", "_cwrun_v", 3);
+    sprintf(decl, "const qr_row *const qr_datamask[%u]", ver_max);
+    _print_index(decl, "_datamask_v", ver_max);
+    sprintf(decl, "const qr_row *const qr_template[%u]", ver_max);
+    _print_index(decl, "_template_v", ver_max);
+    _print_index("const uint8_t (*const qr_eccunit[3])[16]", "_eccunit_v", 3);
+    sprintf(decl, "const qr_row *const qr_format_row[%u]", ver_max);
+    _print_index(decl, "_format_row_v", ver_max);
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * Load generator for the encoding daemon (daemon_host.c).
+ *
+ * Built by `make qrload` with newlib_host.h in place of newlib.h; qrcode.c
+ * is included for -v only, to check every reply against a local qr_encode.
+ *
+ * Usage: ./qrload [-c conns] [-n requests] [-b sizes] [-v] [socket]
+ *
+ * For each batch size of the comma-separated list (default 1,4,16,64), it
+ * sets the daemon's batch size (QRD_BATCH), then runs `requests` encodes
+ * over `conns` connections, one thread per connection, each thread sending
+ * its next request as soon as the reply to the previous one is in. It
+ * prints the throughput and the p50/p99 request latency of each size.
+ */
+
+#include "qrcode.c"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+
+#include "qrd_proto.h"
+
+#define QRL_CONNS_MAX 256
+#define QRL_SIZES_MAX 16
+
+typedef struct qrl_thread {
+    _Alignas(64) pthread_t tid;
+    uint id;
+    int fd;
+    unsigned long n;     // requests to send
+    uint32_t *lat;       // ns per request
+    unsigned long bad;   // replies that are not what was asked for
+} qrl_thread;
+
+static const char *_path = QRD_SOCKET;
+static bool _verify;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static int _connect(void)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    strncpy(addr.sun_path, _path, sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr))) {
+        perror(_path);
+        exit(1);
+    }
+    return fd;
+}
+
+static bool _xfer(int fd, const uint8_t *req, uint n, qrd_reply *r)
+{
+    if (write(fd, req, n) != (ssize_t) n)
+        return false;
+    for (size_t got = 0; got < sizeof(*r);) {
+        ssize_t k = read(fd, (uint8_t *) r + got, sizeof(*r) - got);
+        if (k <= 0)
+            return false;
+        got += k;
+    }
+    return true;
+}
+
+/* Does r hold the symbol of data? */
+static bool _check(const qrd_reply *r, const uint8_t *data, uint len)
+{
+    qr_ctx ctx[1];
+    uint ver = 1;
+
+    while (ver <= 3 && !qr_eval(ctx, ver, data, len))
+        ver++;
+    if (ver > 3)
+        return r->status == QRD_TOOLONG;
+    qr_encode(ctx);
+    if (r->status != QRD_OK || r->ver != ver || r->mask != ctx->mask)
+        return false;
+    for (uint y = 0; y < ctx->size; y++)
+        if (r->rows[y] != (uint32_t) (ctx->bmp[y] >> (QR_ROW_BITS - 32)))
+            return false;
+    return true;
+}
+
+static void *_client(void *arg)
+{
+    qrl_thread *t = arg;
+    uint8_t req[2 + 64];
+    qrd_reply r;
+
+    for (unsigned long i = 0; i < t->n; i++) {
+        /* URL-like payloads of 32 to 50 bytes (V2 and V3). */
+        char *p = (char *) req + 2;
+        int len = sprintf(p, "https://github.com/sysprog21/%u/%lu", t->id, i);
+        len += sprintf(p + len, "%.*s", (int) (i % 12), "-rv32emu-qr-");
+        req[0] = QRD_ENCODE;
+        req[1] = len;
+        uint64_t t0 = _now_ns();
+        if (!_xfer(t->fd, req, 2 + len, &r)) {
+            fprintf(stderr, "qrload: connection lost\n");
+            exit(1);
+        }
+        t->lat[i] = _now_ns() - t0;
+        if (r.status != QRD_OK || r.len != len ||
+            (_verify && !_check(&r, req + 2, len)))
+            t->bad++;
+    }
+    return NULL;
+}
+
+static int _cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+    return x < y ? -1 : x > y;
+}
+
+int main(int argc, char **argv)
+{
+    static qrl_thread th[QRL_CONNS_MAX];
+    uint sizes[QRL_SIZES_MAX] = {1, 4, 16, 64}, nsizes = 4;
+    uint conns = 64;
+    unsigned long total = 200000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:b:v")) != -1) {
+        if (opt == 'c') {
+            conns = strtoul(optarg, NULL, 0);
+        } else if (opt == 'n') {
+            total = strtoul(optarg, NULL, 0);
+        } else if (opt == 'b') {
+            char *p = optarg;
+            for (nsizes = 0; *p && nsizes < QRL_SIZES_MAX; p += *p == ',')
+                sizes[nsizes++] = strtoul(p, &p, 0);
+        } else if (opt == 'v') {
+            _verify = true;
+        } else {
+            conns = 0;
+        }
+    }
+    if (optind < argc)
+        _path = argv[optind];
+    if (!conns || conns > QRL_CONNS_MAX || total < conns) {
+        fprintf(stderr,
+                "usage: %s [-c conns] [-n requests] [-b sizes] [-v] [socket]\n",
+                argv[0]);
+        return 1;
+    }
+
+    unsigned long per = total / conns;
+    uint32_t *lat = malloc(per * conns * sizeof(*lat));
+    if (!lat) {
+        perror("malloc");
+        return 1;
+    }
+    int ctl = _connect();
+    for (uint t = 0; t < conns; t++) {
+        th[t].id = t;
+        th[t].fd = _connect();
+        th[t].n = per;
+        th[t].lat = lat + t * per;
+    }
+
+    printf("qrload: %u connections, %lu requests per batch size%s\n", conns,
+           per * conns, _verify ? ", replies verified" : "");
+    printf("%5s %13s %9s %9s\n", "Batch", "Throughput/s", "p50 us", "p99 us");
+    for (uint s = 0; s < nsizes; s++) {
+        uint8_t req[2] = {QRD_BATCH, sizes[s]};
+        qrd_reply r;
+        if (!sizes[s] || sizes[s] > 255 || !_xfer(ctl, req, 2, &r) ||
+            r.status != QRD_OK) {
+            fprintf(stderr, "qrload: batch size %u refused\n", sizes[s]);
+            return 1;
+        }
+
+        uint64_t t0 = _now_ns();
+        for (uint t = 0; t < conns; t++) {
+            th[t].bad = 0;
+            if (pthread_create(&th[t].tid, NULL, _client, &th[t])) {
+                perror("pthread_create");
+                return 1;
+            }
+        }
+        unsigned long bad = 0;
+        for (uint t = 0; t < conns; t++) {
+            pthread_join(th[t].tid, NULL);
+            bad += th[t].bad;
+        }
+        double secs = (_now_ns() - t0) / 1e9;
+
+        qsort(lat, per * conns, sizeof(*lat), _cmp_u32);
+        printf("%5u %13.0f %9.1f %9.1f", sizes[s], per * conns / secs,
+               lat[per * conns / 2] / 1e3, lat[per * conns * 99 / 100] / 1e3);
+        if (bad)
+            printf("  %lu bad replies", bad);
+        printf("\n");
+        fflush(stdout);
+    }
+    return 0;
+}
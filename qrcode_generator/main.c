@@ -1,25 +1,30 @@
 #include <stdint.h>
 #include "newlib.h"
-#define CODE_OPT_VER 2
 extern uint64_t get_cycles(void);
 extern uint64_t get_instret(void);
 
 
 /* ============= Test QR code Declaration ============= */
 extern int generate_qrcode(void);
-extern int generate_qrcode_opt_v1(void);
-extern int generate_qrcode_opt_v2(void);
+extern int generate_qrcode_gf(void);
+extern int generate_qrcode_batch(void);
+extern int generate_qrcode_mask_cost(void);
+extern int generate_qrcode_blit(void);
+extern int generate_qrcode_update(void);
+extern int generate_qrcode_iov(void);
+extern int generate_qrcode_lowmem(void);
+extern int generate_qrcode_auto(void);
+extern int generate_qrcode_cache(void);
+extern int generate_qrcode_versions(void);
+extern int generate_qrcode_static(void);
+extern int generate_qrcode_levels(void);
+extern int generate_qrcode_verify(void);
+extern int generate_qrcode_half(void);
 /* ============= Test Suite ============= */
 static void test_generate_qrcode(void)
 {
     TEST_LOGGER("Generate_qrcode...\n");
-#if CODE_OPT_VER == 0
     int ret = generate_qrcode();
-#elif CODE_OPT_VER == 1
-    int ret = generate_qrcode_opt_v1();
-#elif CODE_OPT_VER == 2
-    int ret = generate_qrcode_opt_v2();
-#endif
     if(ret == 0)
     {
 
@@ -32,18 +37,61 @@ static void test_generate_qrcode(void)
         printstr(exit_msg, str_len(exit_msg));
     }
 }
+/* One test of the suite: its title line and the harness that runs it. */
+typedef struct qr_test {
+    const char *title;
+    int (*run)(void);
+} qr_test;
+
+static const qr_test _tests[] = {
+    {"\nTest G: V3 symbol with each GF multiply backend of the RS stage\n",
+     generate_qrcode_gf},
+    {"\nTest B: 32 x V3 symbols, LUT ECC one by one vs bit-sliced ECC batch\n",
+     generate_qrcode_batch},
+    {"\nTest M: V3 mask selection, 8 masks scored with the ISO penalty rules\n",
+     generate_qrcode_mask_cost},
+    {"\nTest F: V3 symbol blitted into a 1bpp framebuffer at scale 4\n",
+     generate_qrcode_blit},
+    {"\nTest U: V3 symbol with its last two payload bytes changed by qr_update\n",
+     generate_qrcode_update},
+    {"\nTest S: V3 symbol from a URL prefix and an ID suffix as two fragments\n",
+     generate_qrcode_iov},
+    {"\nTest L: V3 symbol encoded without the codeword buffer\n",
+     generate_qrcode_lowmem},
+    {"\nTest A: numeric and alphanumeric payloads, byte mode V3 vs automatic segments and version\n",
+     generate_qrcode_auto},
+    {"\nTest C: 256 V3 requests over 255 URLs with Zipf-like popularity, qr_encode vs qr_encode_cached\n",
+     generate_qrcode_cache},
+    {"\nTest V: full-capacity byte-mode symbol of every version built in (VER_MAX)\n",
+     generate_qrcode_versions},
+    {"\nTest R: symbols rendered at build time (qr_static.def) vs qr_encode\n",
+     generate_qrcode_static},
+    {"\nTest E: full-capacity V3 symbol at error correction levels L, M, Q, H\n",
+     generate_qrcode_levels},
+    {"\nTest D: encoded symbols decoded back from the bitmap and verified\n",
+     generate_qrcode_verify},
+    {"\nTest H: V3 symbol dumped in half-block mode, two module rows per line\n",
+     generate_qrcode_half},
+};
+
+/* Print the title, run the harness and report a nonzero return code. */
+static void run_test(const qr_test *t)
+{
+    printstr(t->title, str_len(t->title));
+    int ret = t->run();
+    if(ret != 0)
+    {
+        char exit_msg[32] = "Exit with error code ";
+        sprintf(exit_msg + str_len(exit_msg), "%d.\n", ret); // add '\0' automatically
+        printstr(exit_msg, str_len(exit_msg));
+    }
+}
 int main(void)
 {
     uint64_t start_cycles, end_cycles, cycles_elapsed;
     uint64_t start_instret, end_instret, instret_elapsed;
     TEST_LOGGER("\n=== QR code Tests ===\n\n");
-#if CODE_OPT_VER == 0
-    TEST_LOGGER("Test 0: QR code (Original reference C code)\n");
-#elif CODE_OPT_VER == 1
-    TEST_LOGGER("Test 1: QR code (Optimize code v1, use risc-v assembly to implement _rs_mul)\n");
-#elif CODE_OPT_VER == 2
-    TEST_LOGGER("Test 2: QR code (Optimize code v1, use risc-v assembly to implement _rs_mul, and exclude unnecessary mul_loop)\n");
-#endif
+    TEST_LOGGER("Test 0: QR code (LUT GF backend)\n");
     start_cycles = get_cycles();
     start_instret = get_instret();
 
@@ -60,6 +108,9 @@ int main(void)
     print_dec((unsigned long) instret_elapsed);
     TEST_LOGGER("\n");
 
+    for (unsigned i = 0; i < sizeof(_tests) / sizeof(_tests[0]); i++)
+        run_test(&_tests[i]);
+
     TEST_LOGGER("\n=== All Tests Completed ===\n");
 
     return 0;
@@ -0,0 +1,83 @@
+#ifndef NEWLIB_H
+#define NEWLIB_H
+
+/*
+ * Host stand-in for newlib.h, for building the encoder natively (x86-64
+ * Linux, see bench_host.c and `make bench`).
+ *
+ * It is force-included ahead of the sources with -include, and takes the
+ * NEWLIB_H guard so their own #include "newlib.h" becomes a no-op. The
+ * string and I/O functions come from the host C library; printstr is a
+ * write(2) to stdout. get_cycles reads the TSC (or a nanosecond clock off
+ * x86); get_instret has no host counterpart and returns 0.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ============= Macros ============= */
+
+#define printstr(ptr, length)             \
+    do {                                  \
+        if (write(1, ptr, length) < 0) {} \
+    } while (0)
+
+#define TEST_OUTPUT(msg, length) printstr(msg, length)
+
+#define TEST_LOGGER(msg)                     \
+    {                                        \
+        char _msg[] = msg;                   \
+        TEST_OUTPUT(_msg, sizeof(_msg) - 1); \
+    }
+
+/* ============= Standard C Library Functions ============= */
+
+static inline uint32_t str_len(const char *s)
+{
+    return strlen(s);
+}
+
+/* ============= Utility Functions ============= */
+
+/* stdio is flushed so the text keeps its place among printstr writes. */
+static inline void print_dec(unsigned long val)
+{
+    printf("%lu\n", val);
+    fflush(stdout);
+}
+
+static inline void print_dec_wo_n(unsigned long val)
+{
+    printf("%lu", val);
+    fflush(stdout);
+}
+
+static inline void print_hex(unsigned long val)
+{
+    printf("%lx\n", val);
+    fflush(stdout);
+}
+
+/* ============= Performance counters (perfcounter.S) ============= */
+
+static inline uint64_t get_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t get_instret(void)
+{
+    return 0;
+}
+
+#endif /* NEWLIB_H */
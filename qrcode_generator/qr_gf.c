@@ -0,0 +1,167 @@
+/*
+ * Software GF(2^8) multiply backends of the Reed-Solomon stage: the
+ * iterative C multiply and the two RV32I assembly versions of it (no M
+ * extension, so no mul instruction). See qr_gf.h.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "qr_gf.h"
+
+static inline uint _rs_mul_iter(uint x, uint y)
+{
+    uint z = 0;
+    /* This is called (133, 340, 825) times in V(1, 2, 3) ECC calculation. */
+    for (int i = 7; i >= 0; i--) {
+        /* And this body is run 1064, 2720, 6600 times. */
+        z = (z << 1) ^ ((z >> 7) * 0x11D); // 0x11d = 285
+        z ^= ((y >> i) & 1) * x;
+    }
+    return z;
+}
+
+#define QR_RS_NAME qr_rs_iter
+#define QR_RS_TERM(g, f) _rs_mul_iter(g, f)
+#include "qr_rs.h"
+
+#ifdef __riscv /* host builds (bench_host.c) get the C backends only */
+/*
+ * The assembly versions use numeric local labels (1: ... 1b), so the asm
+ * stays valid however many times the compiler inlines or unrolls it.
+ */
+static inline uint _rs_mul_asm_v1(uint x, uint y)
+{
+    /* Reed-Solomon GF(2^8) multiplication using inline assembly
+     * Input: x (multiplicand), y (multiplier)
+     * Output: result
+     * Algorithm matches _rs_mul_iter:
+     *   z = 0
+     *   for i = 7 down to 0:
+     *     z = (z << 1) ^ ((z >> 7) * 0x11D)
+     *     z ^= ((y >> i) & 1) * x
+     */
+    uint result;
+    asm volatile(
+        "li t0, 0\n"              /* z = 0 */
+        "li t1, 7\n"              /* i = 7 (counter) */
+        "mv t6, %1\n"             /* Save x in t6 */
+        
+        "1:\n"
+        "  slli a2, t0, 1\n"      /* a2 = z << 1 */
+        
+        /* Calculate (z >> 7) * 0x11D */
+        "  srli a3, t0, 7\n"      /* a3 = z >> 7 */
+        "  mv a4, a3\n"           /* a4 = a3 (bit 0) */
+        "  slli t3, a3, 2\n"      /* t3 = a3 << 2 (bit 2) */
+        "  add a4, a4, t3\n"
+        "  slli t3, a3, 3\n"      /* t3 = a3 << 3 (bit 3) */
+        "  add a4, a4, t3\n"
+        "  slli t3, a3, 4\n"      /* t3 = a3 << 4 (bit 4) */
+        "  add a4, a4, t3\n"
+        "  slli t3, a3, 8\n"      /* t3 = a3 << 8 (bit 8) */
+        "  add a4, a4, t3\n"      /* a4 = (z >> 7) * 0x11D */
+        
+        "  xor t0, a2, a4\n"      /* z = (z << 1) ^ ((z >> 7) * 0x11D) */
+        
+        /* Calculate ((y >> i) & 1) * x */
+        "  srl a4, %2, t1\n"      /* a4 = y >> i */
+        "  andi a4, a4, 1\n"      /* a4 = (y >> i) & 1 */
+        
+        /* Multiply a4 * x (where x is in t6) */
+        "  li a5, 0\n"            /* result = 0 */
+        "  mv t3, t6\n"           /* t3 = x (multiplicand) */
+        "  mv t4, a4\n"           /* t4 = (y >> i) & 1 (multiplier, 0 or 1) */
+        
+        "2:\n"
+        "  beqz t4, 3f\n"
+        "  andi t5, t4, 1\n"
+        "  beqz t5, 4f\n"
+        "  add a5, a5, t3\n"
+        "4:\n"
+        "  slli t3, t3, 1\n"
+        "  srli t4, t4, 1\n"
+        "  j 2b\n"
+        
+        "3:\n"
+        "  xor t0, t0, a5\n"      /* z ^= ((y >> i) & 1) * x */
+        
+        "  addi t1, t1, -1\n"     /* i-- */
+        "  bgez t1, 1b\n"          /* if i >= 0, continue loop */
+        
+        "  mv %0, t0\n"           /* return z */
+        : "=r"(result)            /* Output: result */
+        : "r"(x), "r"(y)          /* Inputs: x, y */
+        : "t0", "t1", "t3", "t4", "t5", "t6", "a2", "a3", "a4", "a5"  /* Clobbered registers */
+    );
+    return result;
+}
+/* As v1, without the mul_loop: both multiplies are by 0 or 1. */
+static inline uint _rs_mul_asm_v2(uint x, uint y)
+{
+    /* Reed-Solomon GF(2^8) multiplication using inline RISC-V assembly
+     * Input: x (multiplicand), y (multiplier)
+     * Output: result
+     * Algorithm matches _rs_mul_iter:
+     *   z = 0
+     *   for i = 7 down to 0:
+     *     z = (z << 1) ^ ((z >> 7) * 0x11D)
+     *     z ^= ((y >> i) & 1) * x
+     */
+    uint result;
+    asm volatile(
+        "li t0, 0\n"              /* z = 0 */
+        "li t1, 7\n"              /* i = 7 (counter) */
+        "mv t6, %1\n"             /* Save x in t6 */
+        
+        "1:\n"
+        "  slli a2, t0, 1\n"      /* a2 = z << 1 */
+        
+        /* Calculate (z >> 7) * 0x11D without mul_loop
+            0x11D = 0b100011101, 1 at position 0,2,3,4,8 
+            So, calculate the a3 << 2,3,4,8 and sum them.
+        */
+        "  srli a3, t0, 7\n"      /* a3 = z >> 7 */
+        "  beqz a3, 2f\n"          /* if (z >> 7) == 0, skip multiplication */
+        "  mv a4, a3\n"           /* a4 = a3 (bit 0) */
+        "  slli t3, a3, 2\n"      /* t3 = a3 << 2 (bit 2) */
+        "  add a4, a4, t3\n"
+        "  slli t3, a3, 3\n"      /* t3 = a3 << 3 (bit 3) */
+        "  add a4, a4, t3\n"
+        "  slli t3, a3, 4\n"      /* t3 = a3 << 4 (bit 4) */
+        "  add a4, a4, t3\n"
+        "  slli t3, a3, 8\n"      /* t3 = a3 << 8 (bit 8) */
+        "  add a4, a4, t3\n"      /* a4 = (z >> 7) * 0x11D */
+        "  xor t0, a2, a4\n"      /* z = (z << 1) ^ ((z >> 7) * 0x11D) */
+        "  j 3f\n"
+        "2:\n"
+        "  mv t0, a2\n"             /* let t0 be (z << 1)*/
+        "3:\n"
+        /* Calculate ((y >> i) & 1) * x 
+            (y >> i) & 1 must be 1 or 0, so it is simple to do this multiplication
+            Just check if it is 1, if true, do the xor.
+        */
+        "  srl a4, %2, t1\n"      /* a4 = y >> i */
+        "  andi a4, a4, 1\n"      /* a4 = (y >> i) & 1 */
+        
+        "  beqz a4, 4f\n"          /* if (y >> i) & 1 == 0, skip XOR */
+        "  xor t0, t0, t6\n"       /* z ^= x */
+        "4:\n"
+        "  addi t1, t1, -1\n"      /* i-- */
+        "  bgez t1, 1b\n"          /* if i >= 0, continue loop */
+        
+        "  mv %0, t0\n"            /* return z */
+        : "=r"(result)             /* Output: result */
+        : "r"(x), "r"(y)           /* Inputs: x, y */
+        : "t0", "t1", "t3", "t6", "a2", "a3", "a4"  /* Clobbered: Remind those registers will be modified */
+    );
+    return result;
+}
+
+#define QR_RS_NAME qr_rs_asm_v1
+#define QR_RS_TERM(g, f) _rs_mul_asm_v1(g, f)
+#include "qr_rs.h"
+
+#define QR_RS_NAME qr_rs_asm_v2
+#define QR_RS_TERM(g, f) _rs_mul_asm_v2(g, f)
+#include "qr_rs.h"
+#endif /* __riscv */
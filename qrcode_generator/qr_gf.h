@@ -0,0 +1,57 @@
+#ifndef QR_GF_H
+#define QR_GF_H
+
+/*
+ * GF(2^8) multiply backends of the Reed-Solomon stage.
+ *
+ * Each backend is one instance of the ring-buffer RS loop (qr_rs.h) around
+ * its own multiply, so the product stays a direct call or inline code in the
+ * inner loop and only the RS call itself goes through a pointer. qrcode.c
+ * holds the backend table; qr_gf_select() picks the one qr_encode uses.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "qr_tables.h"
+
+typedef unsigned uint;
+
+/* ECC codewords per RS block, any level: V2-H, or V9-L past V3. */
+#if QR_VER_MAX > 3
+#define QR_ECC_MAX 30
+#else
+#define QR_ECC_MAX 28
+#endif
+
+/*
+ * Write the deg ECC codewords of the len data codewords at data to ecc, one
+ * RS block. gen is the generator polynomial without its leading 1, highest
+ * term first: as logs for backends with log_gen set, as plain values
+ * (qr_params.gen_val) otherwise.
+ */
+typedef void (*qr_rs_fn)(const uint8_t *gen, uint deg, const uint8_t *data,
+                         uint len, uint8_t *ecc);
+
+typedef struct qr_gf_backend {
+    const char *name;
+    qr_rs_fn rs;
+    bool log_gen;
+} qr_gf_backend;
+
+void qr_rs_lut(const uint8_t *gen, uint deg, const uint8_t *data, uint len,
+               uint8_t *ecc);
+void qr_rs_iter(const uint8_t *gen, uint deg, const uint8_t *data, uint len,
+                uint8_t *ecc);
+void qr_rs_asm_v1(const uint8_t *gen, uint deg, const uint8_t *data, uint len,
+                  uint8_t *ecc);
+void qr_rs_asm_v2(const uint8_t *gen, uint deg, const uint8_t *data, uint len,
+                  uint8_t *ecc);
+void qr_rs_clmul(const uint8_t *gen, uint deg, const uint8_t *data, uint len,
+                 uint8_t *ecc);
+void qr_rs_x86(const uint8_t *gen, uint deg, const uint8_t *data, uint len,
+               uint8_t *ecc);
+
+/* Kernel behind qr_rs_x86 on this CPU: "AVX2", "SSSE3" or "LUT". */
+const char *qr_gf_x86_kernel(void);
+
+#endif /* QR_GF_H */
@@ -0,0 +1,148 @@
+/*
+ * x86-64 host GF(2^8) backend of the Reed-Solomon stage: SSSE3/AVX2 pshufb
+ * nibble tables, picked by CPUID when the program starts. It is built for
+ * the host tools only (QR_GF_X86=1, see Makefile); see qr_gf.h.
+ *
+ * The residual is kept in vector registers, leading term in byte 0. Per
+ * data codeword, the factor f = data ^ residual[0] picks the two 16-entry
+ * tables of "multiply by f" (f times the low nibble, f times the high
+ * nibble), pshufb looks up every generator coefficient's nibbles at once,
+ * and the residual moves down one byte and takes the product: all deg terms
+ * in one or two instructions, no branch on f. Without SSSE3 it falls back to
+ * qr_rs_lut, which takes the same log generator.
+ */
+
+#include <immintrin.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "qr_gf.h"
+
+/* _mul[f][0][n] = f * n, _mul[f][1][n] = f * (n << 4). */
+static _Alignas(16) uint8_t _mul[256][2][16];
+static uint8_t _exp[256];
+
+static qr_rs_fn _rs = qr_rs_lut;
+static const char *_kernel = "LUT";
+
+static uint _gf_mul(uint x, uint y)
+{
+    uint z = 0;
+    for (; y; y >>= 1) {
+        if (y & 1)
+            z ^= x;
+        x <<= 1;
+        if (x & 0x100)
+            x ^= 0x11D;
+    }
+    return z;
+}
+
+/* Generator values of gen (logs), zero past deg. */
+static void _gen_values(uint8_t *g, const uint8_t *gen, uint deg)
+{
+    for (uint j = 0; j < 32; j++)
+        g[j] = j < deg ? _exp[gen[j]] : 0;
+}
+
+__attribute__((target("ssse3"))) static void _rs_ssse3(const uint8_t *gen,
+                                                       uint deg,
+                                                       const uint8_t *data,
+                                                       uint len,
+                                                       uint8_t *ecc)
+{
+    _Alignas(16) uint8_t g[32];
+    const __m128i nib = _mm_set1_epi8(0x0F);
+
+    _gen_values(g, gen, deg);
+    __m128i g0 = _mm_load_si128((const __m128i *) g);
+    __m128i g1 = _mm_load_si128((const __m128i *) (g + 16));
+    __m128i g0l = _mm_and_si128(g0, nib);
+    __m128i g0h = _mm_and_si128(_mm_srli_epi16(g0, 4), nib);
+    __m128i g1l = _mm_and_si128(g1, nib);
+    __m128i g1h = _mm_and_si128(_mm_srli_epi16(g1, 4), nib);
+    __m128i r0 = _mm_setzero_si128(), r1 = _mm_setzero_si128();
+
+    for (uint i = 0; i < len; i++) {
+        uint f = (data[i] ^ _mm_cvtsi128_si32(r0)) & 0xFF;
+        __m128i tl = _mm_load_si128((const __m128i *) _mul[f][0]);
+        __m128i th = _mm_load_si128((const __m128i *) _mul[f][1]);
+        r0 = _mm_alignr_epi8(r1, r0, 1);
+        r1 = _mm_srli_si128(r1, 1);
+        r0 = _mm_xor_si128(r0, _mm_xor_si128(_mm_shuffle_epi8(tl, g0l),
+                                             _mm_shuffle_epi8(th, g0h)));
+        r1 = _mm_xor_si128(r1, _mm_xor_si128(_mm_shuffle_epi8(tl, g1l),
+                                             _mm_shuffle_epi8(th, g1h)));
+    }
+
+    _mm_store_si128((__m128i *) g, r0);
+    _mm_store_si128((__m128i *) (g + 16), r1);
+    for (uint j = 0; j < deg; j++)
+        ecc[j] = g[j];
+}
+
+__attribute__((target("avx2"))) static void _rs_avx2(const uint8_t *gen,
+                                                     uint deg,
+                                                     const uint8_t *data,
+                                                     uint len,
+                                                     uint8_t *ecc)
+{
+    _Alignas(32) uint8_t g[32];
+    const __m256i nib = _mm256_set1_epi8(0x0F);
+
+    _gen_values(g, gen, deg);
+    __m256i gv = _mm256_load_si256((const __m256i *) g);
+    __m256i gl = _mm256_and_si256(gv, nib);
+    __m256i gh = _mm256_and_si256(_mm256_srli_epi16(gv, 4), nib);
+    __m256i r = _mm256_setzero_si256();
+
+    for (uint i = 0; i < len; i++) {
+        uint f = (data[i] ^ _mm_cvtsi128_si32(_mm256_castsi256_si128(r))) &
+                 0xFF;
+        __m256i tl = _mm256_broadcastsi128_si256(
+            _mm_load_si128((const __m128i *) _mul[f][0]));
+        __m256i th = _mm256_broadcastsi128_si256(
+            _mm_load_si128((const __m128i *) _mul[f][1]));
+        /* Down one byte across the two 128-bit lanes. */
+        __m256i up = _mm256_permute2x128_si256(r, r, 0x81);
+        r = _mm256_alignr_epi8(up, r, 1);
+        r = _mm256_xor_si256(r, _mm256_xor_si256(_mm256_shuffle_epi8(tl, gl),
+                                                 _mm256_shuffle_epi8(th, gh)));
+    }
+
+    _mm256_store_si256((__m256i *) g, r);
+    for (uint j = 0; j < deg; j++)
+        ecc[j] = g[j];
+}
+
+/* Build the tables and pick the kernel, before main and any thread. */
+__attribute__((constructor)) static void _gf_x86_init(void)
+{
+    for (uint f = 0; f < 256; f++) {
+        for (uint n = 0; n < 16; n++) {
+            _mul[f][0][n] = _gf_mul(f, n);
+            _mul[f][1][n] = _gf_mul(f, n << 4);
+        }
+    }
+    for (uint i = 0, x = 1; i < 256; i++, x = _gf_mul(x, 2))
+        _exp[i] = x;
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        _rs = _rs_avx2;
+        _kernel = "AVX2";
+    } else if (__builtin_cpu_supports("ssse3")) {
+        _rs = _rs_ssse3;
+        _kernel = "SSSE3";
+    }
+}
+
+void qr_rs_x86(const uint8_t *gen, uint deg, const uint8_t *data, uint len,
+               uint8_t *ecc)
+{
+    _rs(gen, deg, data, len, ecc);
+}
+
+const char *qr_gf_x86_kernel(void)
+{
+    return _kernel;
+}
@@ -0,0 +1,53 @@
+/*
+ * Ring-buffer Reed-Solomon loop, included once per GF multiply backend (no
+ * include guard on purpose). Define before including:
+ *
+ *   QR_RS_NAME        name of the qr_rs_fn to define (see qr_gf.h)
+ *   QR_RS_TERM(g, f)  product of generator coefficient g and factor f
+ *   QR_RS_FACTOR(f)   optional: the factor as QR_RS_TERM takes it (e.g. log)
+ *
+ * The residual lives in a ring buffer: rather than shifting it left by one
+ * byte per input codeword, the head index moves forward and the freed slot
+ * becomes the new lowest term. Zero factors leave the residual unchanged and
+ * skip the multiply loop entirely.
+ */
+
+void QR_RS_NAME(const uint8_t *gen, uint deg, const uint8_t *data, uint len,
+                uint8_t *ecc)
+{
+    uint8_t ring[QR_ECC_MAX];
+    uint h = 0; // ring[h] is the leading residual term
+
+    for (uint j = 0; j < deg; j++)
+        ring[j] = 0;
+
+    for (uint i = 0; i < len; i++) {
+        uint factor = data[i] ^ ring[h];
+        ring[h] = 0;
+        if (++h == deg)
+            h = 0;
+        if (!factor)
+            continue;
+#ifdef QR_RS_FACTOR
+        factor = QR_RS_FACTOR(factor);
+#endif
+        /* Term j is at ring[h + j], wrapping to ring[0] once past deg. */
+        uint k = h;
+        for (uint j = 0; j < deg; j++) {
+            ring[k] ^= QR_RS_TERM(gen[j], factor);
+            if (++k == deg)
+                k = 0;
+        }
+    }
+
+    /* Unroll the ring into the ECC area, leading term first. */
+    for (uint j = 0; j < deg; j++) {
+        ecc[j] = ring[h];
+        if (++h == deg)
+            h = 0;
+    }
+}
+
+#undef QR_RS_NAME
+#undef QR_RS_TERM
+#undef QR_RS_FACTOR
@@ -0,0 +1,31 @@
+#ifndef QR_STATIC_H
+#define QR_STATIC_H
+
+/*
+ * Symbols of the payloads of qr_static.def, fully rendered at build time.
+ *
+ * qr_static.c is generated by gen_static.c, which runs the encoder itself on
+ * the host (see Makefile). Index qr_static_l with QR_STATIC_<name>.
+ */
+
+#include <stdint.h>
+#include "qr_tables.h"
+
+enum {
+#define QR_STATIC(name, ver, str) QR_STATIC_##name,
+#include "qr_static.def"
+#undef QR_STATIC
+    QR_NSTATIC
+};
+
+typedef struct qr_static {
+    const uint8_t *data; // payload
+    uint16_t len;
+    uint8_t ver;
+    uint8_t mask;        // data mask qr_encode chose
+    const qr_row *bmp;   // ver * 4 + 17 rows
+} qr_static;
+
+extern const qr_static qr_static_l[QR_NSTATIC];
+
+#endif /* QR_STATIC_H */
@@ -0,0 +1,134 @@
+#ifndef QR_TABLES_H
+#define QR_TABLES_H
+
+/*
+ * Precomputed QR123 tables.
+ *
+ * The definitions live in qr_tables.c, which is generated at build time by
+ * gen_tables.c (see Makefile). Tables are indexed by version - 1.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Highest version the encoder is built for, 3-10 (Makefile VER_MAX; the
+ * tables must be generated for the same value). Rows of up to 32 modules (V3)
+ * fit a 32-bit word; V4-V10 (33-57 modules) take 64-bit row words.
+ */
+#ifndef QR_VER_MAX
+#define QR_VER_MAX 3
+#endif
+
+#if QR_VER_MAX > 3
+typedef uint64_t qr_row;
+#define QR_ROW_BITS 64
+#else
+typedef uint32_t qr_row;
+#define QR_ROW_BITS 32
+#endif
+
+/*
+ * One placement run: n (1 or 2) consecutive data bits that go to neighbouring
+ * modules of row y. The first bit lands at bit `shift` of the row word, the
+ * next one at shift + 1 (i.e. one module to the left).
+ */
+typedef struct qr_run {
+    uint8_t y;
+    uint8_t shift;
+    uint8_t n;
+    uint8_t mask; /* (1 << n) - 1 */
+} qr_run;
+
+/* Error correction levels, in qr_params_ecl order. */
+enum { QR_ECL_L, QR_ECL_M, QR_ECL_Q, QR_ECL_H };
+
+/*
+ * Codeword layout of one version at one level. The data codewords are split
+ * into nblk RS blocks, the first nshort of them dlen codewords long and the
+ * others dlen + 1, and each block gets eccdeg ECC codewords. The encoder
+ * keeps them in block order, all data then all ECC; perm gives the
+ * interleaved order the symbol takes them in.
+ */
+typedef struct qr_params {
+    uint16_t capa;          /* total codewords (data + ECC). */
+    uint16_t data;          /* data codewords of all blocks. */
+    uint8_t eccdeg;         /* ECC degree/codewords per block. */
+    uint8_t nblk;           /* RS blocks. */
+    uint8_t dlen;           /* data codewords of a short block. */
+    uint8_t nshort;         /* short blocks, ahead of the long ones. */
+    uint8_t ecl;            /* error correction level (QR_ECL_*). */
+    const uint8_t *gen;     /* ECC generator polynomial as logs. */
+    const uint8_t *gen_val; /* the same as plain values. */
+    const uint16_t *perm;   /* buffer index of the i-th codeword placed;
+                               NULL (identity) for a single block. */
+} qr_params;
+
+/*
+ * Codeword layouts, [QR_ECL_*][version - 1]. Generators are highest term
+ * first, without the leading coefficient (always 1).
+ */
+extern const qr_params qr_params_ecl[4][QR_VER_MAX];
+
+/*
+ * Placement runs in zig-zag order, terminated by an entry with n = 9.
+ * The remainder bits of V2-V6 are not included (they are always 0).
+ */
+extern const qr_run *const qr_runs[QR_VER_MAX];
+
+/*
+ * Start of each codeword (data then ECC) in qr_runs: run index << 1, plus 1
+ * if the codeword starts at the second bit of that run. V1-V3 only.
+ */
+extern const uint16_t *const qr_cwrun[3];
+
+/* Per-row masks of all data modules, including the remainder bits. */
+extern const qr_row *const qr_datamask[QR_VER_MAX];
+
+/*
+ * Data mask patterns 0-7: qr_maskpat[m][y % 12] has the modules of row y that
+ * mask m darkens (MSB is column 0). AND with qr_datamask before use.
+ */
+extern const qr_row qr_maskpat[8][12];
+
+/*
+ * Pixel expansion for scales 1-8: qr_expand[scale - 1][v] repeats each bit of
+ * nibble v (MSB first) scale times, giving 4 * scale bits, right-aligned.
+ */
+extern const uint32_t qr_expand[8][16];
+
+/*
+ * Function patterns (finders, timing, alignment, dark dot and version
+ * information from V7) of each version, one word per row. The format modules
+ * are left light.
+ */
+extern const qr_row *const qr_template[QR_VER_MAX];
+
+/*
+ * Format information, indexed by format data d = level bits << 3 | mask
+ * (level bits: L 1, M 0, Q 3, H 2). qr_format[d] is the BCH-coded word, bit
+ * 14 first. Its modules, as OR masks over a qr_template bitmap: row 8 is
+ * qr_format_row[ver - 1][d]; column 8 has the rows of qr_format_col[d], bits
+ * 0-8 for rows 0-8 and bits 9-15 for the bottom 7 rows.
+ */
+extern const uint16_t qr_format[32];
+extern const uint16_t qr_format_col[32];
+extern const qr_row *const qr_format_row[QR_VER_MAX];
+
+/*
+ * ECC of a unit data codeword: qr_eccunit[v][i][j] is ECC byte j when data
+ * codeword i is 1 and all others are 0. Rows are padded to 16 bytes. V1-V3
+ * only.
+ */
+extern const uint8_t (*const qr_eccunit[3])[16];
+
+/*
+ * Alphanumeric mode value of each byte: 0-9 for digits, 10-44 for the rest of
+ * the set (A-Z, space, $ % * + - . / :), 0xFF if outside it.
+ */
+extern const uint8_t qr_alnum[256];
+
+/* Bit-reversed bytes: MSB-first codeword to LSB-first bit stream. */
+extern const uint8_t qr_rev8[256];
+
+#endif /* QR_TABLES_H */
@@ -1,5 +1,6 @@
 /*
- * QR123: minimal fast QR encoder for version 1, 2, 3.
+ * QR123: minimal fast QR encoder for version 1, 2, 3 (up to 10 when built
+ * with a higher QR_VER_MAX, see qr_tables.h).
  *
  * Copyright (c) 2019 Ling LI <lix2ng@gmail.com>.
  *
@@ -28,22 +29,78 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "newlib.h"
+#include "qr_gf.h"
+#include "qr_static.h"
+#include "qr_tables.h"
 
-typedef unsigned uint;
+extern uint64_t get_cycles(void);
+extern uint64_t get_instret(void);
 
 /*
- * QR_OPT: use log/exp LUT-based GF MUL.
+ * QR_GF_ZBC: list the Zbc clmul backend (qr_gf_zbc.c) in the GF backend
+ * table. Only for cores (or rv32emu builds) with the Zbc extension.
  */
-#define QR_OPT 0
+#ifndef QR_GF_ZBC
+#define QR_GF_ZBC 0
+#endif
+
+/*
+ * QR_DUMP_HALF: dump_bmp packs two module rows per text line (▀/▄/█).
+ */
+#ifndef QR_DUMP_HALF
+#define QR_DUMP_HALF 0
+#endif
+
+#define QR_LINES (QR_VER_MAX * 4 + 17)
+#define QR_DUMP_MAX ((QR_LINES + 2) * ((QR_LINES + 2) * 6 + 1)) // "██" is 6B
+#define QR_LANES 32    // symbols per bit-sliced ECC pass
+#define QR_SEG_MAX 8   // segments of a qr_eval_auto payload
+#define QR_RUN_MAX 64  // character class runs planned by qr_eval_auto
+#if QR_VER_MAX > 3
+#define QR_CHARS_MAX 652 // numeric capacity of V10-L
+#define QR_CW_MAX 346    // codewords of V10
+#define QR_ECC_L_MAX 30  // ECC per block at level L (bit-sliced ECC)
+#else
+#define QR_CHARS_MAX 127 // numeric capacity of V3-L
+#define QR_CW_MAX 70     // codewords of V3
+#define QR_ECC_L_MAX 15
+#endif
+#define QR_CW_WORDS ((QR_CW_MAX + 2 + 3) >> 2) // codeword buffer, and extra 2
+#define QR_INF 0x3FFFFFFF // cost of an impossible mode
+
+/* Row word bit of column x. */
+#define QR_COL(x) ((qr_row) 1 << (QR_ROW_BITS - 1 - (x)))
+#ifndef QR_CACHE_SLOTS
+#define QR_CACHE_SLOTS 64 // qr_cache entries, power of 2 (see qr_cache)
+#endif
+#define QR_CACHE_WAYS 4   // slots probed per lookup, power of 2
+#if QR_CACHE_SLOTS < QR_CACHE_WAYS || (QR_CACHE_SLOTS & (QR_CACHE_SLOTS - 1))
+#error "QR_CACHE_SLOTS must be a power of 2, at least QR_CACHE_WAYS"
+#endif
 
-#define QR_LINES 29
+/* One fragment of a scatter-gather payload. */
+typedef struct qr_iov {
+    const uint8_t *data;
+    uint len;
+} qr_iov;
+
+/* One segment of a mixed-mode payload (qr_eval_auto). */
+typedef struct qr_seg {
+    uint8_t mode; // mode indicator: 1 numeric, 2 alphanumeric, 4 byte
+    uint16_t len; // character count
+} qr_seg;
 
 typedef struct qr_ctx {
-    uint8_t size;            // 21, 25 or 29 (ver*4+17)
-    uint8_t len;             // length of input data.
-    const uint8_t *data;     // input data.
-    void *params;            // data and ECC parameters.
-    uint32_t bmp[QR_LINES];  // QR code bitmap, 1 word per line.
+    uint8_t size;            // 21, 25, ... 57 (ver*4+17)
+    uint16_t len;            // length of input data.
+    uint8_t mask;            // data mask chosen by qr_encode (0-7).
+    uint8_t niov;            // fragment count when iov is set.
+    uint8_t nseg;            // segments (qr_eval_auto), 0 for byte mode.
+    const uint8_t *data;     // input data, or NULL when iov is set.
+    const qr_iov *iov;       // input fragments (qr_eval_iov), else NULL.
+    qr_seg seg[QR_SEG_MAX];  // segments, when nseg is set.
+    const qr_params *params; // data and ECC parameters.
+    qr_row bmp[QR_LINES];    // QR code bitmap, 1 word per line.
 } qr_ctx;
 
 /*
@@ -51,124 +108,54 @@ typedef struct qr_ctx {
  */
 static inline bool qr_getdot(qr_ctx *ctx, uint x, uint y)
 {
-    return ctx->bmp[y] << x >> 31;
+    return ctx->bmp[y] << x >> (QR_ROW_BITS - 1);
 }
 
 /*
- * Draw finders, timing pattern, alignment pattern, and the dark dot.
- * And now the format bits for fixed mask 0.
+ * Start the bitmap from the pre-rendered template of its version (finders,
+ * timing, alignment, dark dot and, from V7, version information), drawn once
+ * at build time by gen_tables.c. A word copy per row. The format modules are
+ * left light; _apply_mask stamps the format word of the chosen level and
+ * mask with _put_format.
  */
-static void _init_bmp(uint32_t A[], uint size)
+static void _init_bmp(qr_row A[], uint size)
 {
-    /* Draw top-left finder. */
-    A[0] = A[6] = 0xFE000000;
-    A[1] = A[5] = 0x82000000;
-    A[2] = A[3] = A[4] = 0xBA000000;
-
-    /* Replicate to bottom-left then top-right. */
-    int y;
-    for (y = 0; y < 7; y++) {
-        A[size - 1 - y] = A[y]; // for bottom-left
-        A[y] |= A[y] >> (size - 7); // for top-right
-    }
-
-    /* Horizontal timing pattern. */
-    A[6] |= 0xAAA800;
-
-    /* Vertical timing pattern. */
-    for (y = 9; y < size - 7; y++)
-        A[y] = ((y + 1) & 1) << 25;
-
-    /* Version and format string
-    Assume the level is L, and the mask pattern is 0.
-    * L : `01`
-    * Mask pattern 5: `000`
-    * First five bits: `01000`
-    * Error correction bits: `1111010110`
-    * Combined string: `010001111010110` (XOR with `101010000010010`)
-    * Format Information Strings: `111011111000100`
-    */
-    /* The dark dot, then some format bits. */
-    // at right side of bottom-left finder pattern
-    y -= 1;  // size-8
-    for (int i = 0; i < 8; i++) {
-        if (i == 4)
-            continue;
-        A[y + i] |= 0x800000;
-    }
- 
-    /* More format bits. */
-    // at right side of top-left finder bottom
-    A[2] |= 0x800000; // format string[12]=1
-    A[7] = 0x800000; // separator and format string[8]=1 at row 7
-    A[8] = 0xEF800000 | 0x31 << (34 - size); // format_string[0-5](111011) + one timing pattern(1) + format_string[6-7](11) + 00000000 + format_string[7-14](11000100)
-    // so A[8] is 1110111110000000011000100(0000000) if size is 25
-
-    /* Alignment pattern for version 2 & 3. */
-    if (size > 21) {
-        uint pat = 0x1F << (36 - size);
-        A[size - 9] |= pat;
-        A[size - 5] |= pat;
-        pat = 0x11 << (36 - size);
-        A[size - 8] |= pat;
-        A[size - 6] |= pat;
-        A[size - 7] |= 0x15 << (36 - size);
-    }
+    const qr_row *t = qr_template[(size - 21) >> 2]; // 21, 25, ... -> 0, 1, ...
+    for (uint y = 0; y < size; y++)
+        A[y] = t[y];
 }
 
-typedef struct qr_params {
-    uint8_t capa;   /* total capacity in bytes. */
-    uint8_t eccdeg; /* ECC degree/byte count. */
-    uint8_t gen[];  /* ECC generator polynomial. */
-} qr_params;
-
 /*
- * Check capacity then setup parameters.
+ * Check capacity then setup parameters, at error correction level ecl
+ * (QR_ECL_L, M, Q or H).
  *
- * Return false if version number is invalid or input exceeds the capacity of
- * specified version.
+ * Return false if version number or level is invalid or input exceeds the
+ * capacity of specified version and level.
  *  - Parameters are written to the context.
  *  - Must evaluate before encoding.
  *  - Must fail if evaluation fails.
- *  Capacity: V1 17B, V2 32B, V3 53B. for byte mode
+ *  Capacity (byte mode, L/M/Q/H): V1 17/14/11/7B, V2 32/26/20/14B,
+ *  V3 53/42/32/24B; at level L, V4 78B, V5 106B, V6 134B, V7 154B, V8 192B,
+ *  V9 230B, V10 271B. V3-Q and V3-H (and most levels past V5) have several
+ *  RS blocks.
  *  reference: https://www.thonky.com/qr-code-tutorial/character-capacities
  */
-bool qr_eval(qr_ctx *ctx, uint ver, const uint8_t *data, uint len)
+bool qr_eval_ecl(qr_ctx *ctx, uint ver, uint ecl, const uint8_t *data,
+                 uint len)
 {
-    static const uint8_t _params_blob[] = {
-        // total code words(data + EC), ECC code words, ECC generator polynomial...(The highest term's coefficient is always 1, so ignore here.)
-        26,   7,    0x7f, 0x7a, 0x9a, 0xa4, 0x0b, 0x44, 0x75,  // V1
-        44,   10,   0xd8, 0xc2, 0x9f, 0x6f, 0xc7, 0x5e, 0x5f,
-        0x71, 0x9d, 0xc1,  // V2
-        70,   15,   0x1d, 0xc4, 0x6f, 0xa3, 0x70, 0x4a, 0x0a,
-        0x69, 0x69, 0x8b,  // V3
-        0x84, 0x97, 0x20, 0x86, 0x1a};
-
-    if (!ctx)
+    if (!ctx || ver < 1 || ver > QR_VER_MAX || ecl > QR_ECL_H)
         return false;
     ctx->data = data;
+    ctx->iov = NULL;
+    ctx->nseg = 0;
     ctx->len = len;
 
-    uintptr_t params = (uintptr_t) _params_blob; /* intentional */
-    /* Skip-overs, cross check with the blob layout. */
-    switch (ver) {
-    case 1:
-        break;
-    case 2:
-        params += 9;
-        break;
-    case 3:
-        params += 21;
-        break;
-    default:
-        return false;
-    }
-
+    /* Codeword layout and generator, from the generated tables. */
+    const qr_params *para = &qr_params_ecl[ecl][ver - 1];
     uint size = ver * 4 + 17;
-    ctx->params = (void *) params;
-    /* 4b mode, 8b count, 4b terminator. */
-    uint usable =
-        ((qr_params *) params)->capa - ((qr_params *) params)->eccdeg - 2;
+    ctx->params = para;
+    /* 4b mode, 8b count (16b from V10), 4b terminator. */
+    uint usable = para->data - 2 - (ver >= 10);
     if (usable < len)
         return false;
 
@@ -177,228 +164,830 @@ bool qr_eval(qr_ctx *ctx, uint ver, const uint8_t *data, uint len)
     return true;
 }
 
+/* Same as qr_eval_ecl, at level L. */
+bool qr_eval(qr_ctx *ctx, uint ver, const uint8_t *data, uint len)
+{
+    return qr_eval_ecl(ctx, ver, QR_ECL_L, data, len);
+}
+
+/*
+ * Same as qr_eval, for a payload given as niov fragments (e.g. a fixed prefix
+ * and a per-item ID). The fragments are read in place at encoding time, so
+ * they must stay valid until then; nothing is copied.
+ */
+bool qr_eval_iov(qr_ctx *ctx, uint ver, const qr_iov iov[], uint niov)
+{
+    uint len = 0;
+    if (niov > 255)
+        return false;
+    for (uint i = 0; i < niov; i++)
+        len += iov[i].len;
+    if (!qr_eval(ctx, ver, NULL, len))
+        return false;
+    ctx->iov = iov;
+    ctx->niov = niov;
+    return true;
+}
+
+/*
+ * Character count bits of a mode: 10, 9 or 8 for versions 1 through 9, and
+ * 12, 11 or 16 from version 10 (wide).
+ */
+static inline uint _count_bits(uint mode, bool wide)
+{
+    if (mode == 1)
+        return wide ? 12 : 10;
+    if (mode == 2)
+        return wide ? 11 : 9;
+    return wide ? 16 : 8;
+}
+
+/*
+ * Exact bit count of a segment: mode, count, then digits in 10-bit groups of
+ * 3 (7 or 4 bits for the rest), alphanumerics in 11-bit pairs (6 for an odd
+ * one) or 8-bit bytes.
+ */
+static uint _seg_bits(uint mode, uint k, bool wide)
+{
+    uint b = 4 + _count_bits(mode, wide);
+    if (mode == 1) {
+        for (; k >= 3; k -= 3)
+            b += 10;
+        return b + (k == 2 ? 7 : k == 1 ? 4 : 0);
+    }
+    if (mode == 2) {
+        uint q = k >> 1;
+        return b + (q << 3) + (q << 1) + q + (k & 1 ? 6 : 0);
+    }
+    return b + (k << 3);
+}
+
+/*
+ * Choose the segment modes and the smallest version (1 to QR_VER_MAX) for a
+ * payload.
+ *
+ * Characters are classed through qr_alnum (digit, alphanumeric or other),
+ * and each maximal run of one class is coded as a whole in a mode that can
+ * hold it; neighbouring runs in the same mode share a segment. A dynamic
+ * program over the runs keeps the cheapest way to end in each mode, in
+ * sixths of a bit: 20, 33 and 48 per character, 84, 78 and 72 per segment
+ * header (the count sizes of V1-V9; V10 only costs the exact bits more). If
+ * that gives more than QR_SEG_MAX segments, or the payload has more than
+ * QR_RUN_MAX runs (which keeps the program's state at 3 bytes per run on the
+ * stack), the payload is one segment in the widest mode it needs.
+ *
+ * Return false if the payload does not fit QR_VER_MAX. The payload must stay
+ * valid until encoded; qr_update takes byte-mode contexts only, and
+ * qr_encode_many encodes mixed-mode ones one by one.
+ */
+bool qr_eval_auto(qr_ctx *ctx, const uint8_t *data, uint len)
+{
+    static const uint8_t _mode[3] = {1, 2, 4};
+    static const uint8_t _head[3] = {84, 78, 72}; // (4 + count bits) * 6
+    uint16_t run[QR_RUN_MAX]; // run lengths
+    uint8_t from[QR_RUN_MAX]; // 2 bits per mode: mode of the run before
+    uint cost[3];
+    uint nrun = 0, widest = 0;
+
+    if (!ctx || len > QR_CHARS_MAX)
+        return false;
+
+    for (uint i = 0; i < len; nrun++) {
+        uint v = qr_alnum[data[i]];
+        uint cl = v < 10 ? 0 : v < 45 ? 1 : 2;
+        uint k = 1;
+        if (nrun == QR_RUN_MAX) { // too mixed: one segment, widest mode
+            for (; i < len && widest < 2; i++) {
+                v = qr_alnum[data[i]];
+                cl = v < 10 ? 0 : v < 45 ? 1 : 2;
+                if (cl > widest)
+                    widest = cl;
+            }
+            nrun = 0;
+            break;
+        }
+        for (; i + k < len; k++) {
+            v = qr_alnum[data[i + k]];
+            if ((v < 10 ? 0 : v < 45 ? 1 : 2) != cl)
+                break;
+        }
+        i += k;
+        run[nrun] = k;
+        if (cl > widest)
+            widest = cl;
+
+        /* Cheapest cost ending in mode m: stay in m, or open a segment. */
+        uint add[3] = {(k << 4) + (k << 2), (k << 5) + k, (k << 5) + (k << 4)};
+        uint next[3], f = 0;
+        for (uint m = 0; m < 3; m++) {
+            uint best = QR_INF, pm = m;
+            if (m < cl) {
+                next[m] = QR_INF;
+                continue;
+            }
+            if (nrun)
+                best = cost[m];
+            for (uint j = 0; j < 3; j++) {
+                uint c = (nrun ? cost[j] : 0) + _head[m];
+                if (j != m && c < best)
+                    best = c, pm = j;
+            }
+            next[m] = best + add[m];
+            f |= pm << (m << 1);
+        }
+        from[nrun] = f;
+        for (uint m = 0; m < 3; m++)
+            cost[m] = next[m];
+    }
+
+    /* Walk back from the cheapest end; from[r] becomes the mode of run r. */
+    uint m = 2;
+    if (nrun) {
+        for (uint j = 0; j < 2; j++)
+            if (cost[j] < cost[m])
+                m = j;
+    }
+    for (uint r = nrun; r-- > 0;) {
+        uint pm = from[r] >> (m << 1) & 3;
+        from[r] = m;
+        m = pm;
+    }
+
+    uint nseg = 0;
+    for (uint r = 0; r < nrun && nseg <= QR_SEG_MAX; r++) {
+        if (nseg && ctx->seg[nseg - 1].mode == _mode[from[r]]) {
+            ctx->seg[nseg - 1].len += run[r];
+        } else if (nseg++ < QR_SEG_MAX) {
+            ctx->seg[nseg - 1].mode = _mode[from[r]];
+            ctx->seg[nseg - 1].len = run[r];
+        }
+    }
+    if (!nseg || nseg > QR_SEG_MAX) {
+        nseg = 1;
+        ctx->seg[0].mode = _mode[widest];
+        ctx->seg[0].len = len;
+    }
+
+    /* Smallest version whose data codewords hold the exact bit count, with
+     * the count sizes of V1-V9 (bits[0]) or of V10 (bits[1]). */
+    uint bits[2] = {0, 0}, ver = 0;
+    for (uint i = 0; i < nseg; i++) {
+        bits[0] += _seg_bits(ctx->seg[i].mode, ctx->seg[i].len, false);
+        bits[1] += _seg_bits(ctx->seg[i].mode, ctx->seg[i].len, true);
+    }
+    while (ver < QR_VER_MAX &&
+           bits[ver >= 9] > (uint) qr_params_ecl[QR_ECL_L][ver].data << 3)
+        ver++;
+    if (ver == QR_VER_MAX)
+        return false;
+
+    /* Let qr_eval set the version up (it checks bytes, so pass no data), then
+     * fill in the segments. */
+    if (!qr_eval(ctx, ver + 1, data, 0))
+        return false;
+    ctx->len = len;
+    ctx->nseg = nseg;
+    return true;
+}
+
+/*
+ * Payload byte k, from the buffer or by walking the fragments.
+ */
+static uint _data_byte(const qr_ctx *ctx, uint k)
+{
+    if (!ctx->iov)
+        return ctx->data[k];
+    const qr_iov *f = ctx->iov;
+    while (k >= f->len)
+        k -= f->len, f++;
+    return f->data[k];
+}
+
+/*
+ * Extra count codeword of a byte-mode symbol: the count takes 16 bits from
+ * version 10 on, 8 before.
+ */
+static inline uint _count_ext(const qr_ctx *ctx)
+{
+    return ctx->size >= 57;
+}
+
+/* A 32-bit word that may alias payload and codeword bytes. */
+typedef uint32_t __attribute__((may_alias)) qr_word;
+
+/*
+ * Payload word at aligned address a, little-endian, with the bytes outside
+ * [lo, hi) read as 0. Only a word wholly inside the payload is loaded as a
+ * word; the partial ones at both ends are assembled a byte at a time, so
+ * nothing outside the payload is read.
+ */
+static inline uint32_t _load_word(uintptr_t a, uintptr_t lo, uintptr_t hi)
+{
+    if (a >= lo && a + 4 <= hi)
+        return *(const qr_word *) a;
+    uint32_t v = 0;
+    for (uint i = 0; i < 4; i++)
+        if (a + i >= lo && a + i < hi)
+            v |= (uint32_t) *(const uint8_t *) (a + i) << (i << 3);
+    return v;
+}
+
+/*
+ * Serialize a contiguous payload up to its terminator, four codewords per
+ * step, as little-endian words (RV32).
+ *
+ * Codeword j is the low nibble of payload byte j - 2 - e and the high nibble
+ * of byte j - 1 - e, e being the extra count codeword (_count_ext). So if S
+ * is the payload word at byte 4k - 1 - e, output word k only moves S's
+ * nibbles across byte lanes, plus one nibble of the previous S. S comes from
+ * aligned loads (_load_word) and a funnel shift, and bytes outside the
+ * payload read as 0.
+ * Codewords 0 to 1 + e and len + 1 + e are then written on their own, and the
+ * rest of the last word is left for the padding.
+ */
+static void _serialize_words(const uint8_t *data, uint len, uint e,
+                             uint32_t *buf)
+{
+    uint8_t *b8 = (uint8_t *) buf;
+
+    if (len) {
+        uintptr_t lo = (uintptr_t) data, hi = lo + len;
+        uintptr_t p = lo - 1 - e;
+        uintptr_t a = p & ~(uintptr_t) 3;
+        uint s = (p & 3) << 3;
+        uint32_t cur = _load_word(a, lo, hi);
+        uint32_t prev = 0;
+        for (uint k = 0; k <= (len + e) >> 2; k++) {
+            a += 4;
+            uint32_t next = _load_word(a, lo, hi);
+            uint32_t S = cur >> s | next << (31 - s) << 1;
+            buf[k] = (S << 12 & 0xF0F0F0F0) | (S >> 4 & 0x0F0F0F0F) |
+                     (prev >> 20 & 0xF0);
+            prev = S;
+            cur = next;
+        }
+        b8[1 + e] = len << 4 | data[0] >> 4;
+        b8[len + 1 + e] = data[len - 1] << 4; // final 4 bits with terminator
+    } else {
+        b8[1 + e] = 0;
+    }
+    /* Mode bits (byte mode) and length bits, 8 for versions 1 through 9, 16
+     * from 10. */
+    if (e) {
+        b8[0] = 0x40 | len >> 12;
+        b8[1] = len >> 4;
+    } else {
+        b8[0] = 0x40 | len >> 4;
+    }
+}
+
 /*
- * Prepare all the data bits before ECC.
+ * Serialize a fragmented payload up to its terminator, a byte at a time.
  */
-static void _serialize_data(qr_ctx *ctx, uint8_t *buf)
+static void _serialize_iov(const qr_ctx *ctx, uint8_t *buf)
 {
-    /* Mode bits and length bits. */
-    // From Versions 1 through 9, the specific required number of bit is 8 for byte mode.
     uint b = 4 << 8 | ctx->len; // byte mode
-    buf[0] = b >> 4; // first code word(8-bit)
     uint i = 0;
-    while (i < ctx->len) {
-        b <<= 8;
-        b |= ctx->data[i++]; // append next code word
-        buf[i] = b >> 4;
+    if (_count_ext(ctx)) { // 16-bit count: its top 4 bits go with the mode
+        buf[i++] = 0x40 | ctx->len >> 12;
+        b = ctx->len & 0xFFF;
+    }
+    buf[i] = b >> 4;
+    for (const qr_iov *f = ctx->iov, *end = f + ctx->niov; f < end; f++) {
+        for (uint k = 0; k < f->len; k++) {
+            b = b << 8 | f->data[k]; // append next code word
+            buf[++i] = b >> 4;
+        }
     }
+    buf[i + 1] = b << 4; // final 4 bits with terminator
+}
 
-    /* Final 4 bits with terminator. */
-    i++;
-    buf[i++] = b << 4;
+/*
+ * Serialize the segments of a qr_eval_auto payload through a bit
+ * accumulator, up to the terminator and the zero bits that end its byte.
+ * Return the index of the first pad codeword.
+ */
+static uint _serialize_segs(const qr_ctx *ctx, uint8_t *buf)
+{
+    const uint8_t *p = ctx->data;
+    bool wide = _count_ext(ctx);
+    uint32_t acc = 0; // pending bits, the last one at bit 0
+    uint n = 0, i = 0;
 
-    /* Byte padding. */
-    b = 0xEC; // 1110 1100 = 8'd236 => 1110 1100 ^ 1111 1101 = 0001 0001 = 8'd17
-    qr_params *para = (qr_params *) ctx->params;
-    while (i < para->capa - para->eccdeg) {
-        buf[i++] = b;
-        b ^= 0xFD; /* alternating EC, 11. */
+    for (uint s = 0; s < ctx->nseg; s++) {
+        uint mode = ctx->seg[s].mode, k = ctx->seg[s].len;
+        uint cbits = _count_bits(mode, wide);
+        acc = (acc << 4 | mode) << cbits | k;
+        for (n += 4 + cbits; n >= 8; n -= 8)
+            buf[i++] = acc >> (n - 8);
+        while (k) {
+            uint v, w;
+            if (mode == 1) { // up to 3 digits in 10 bits
+                uint g = k < 3 ? k : 3;
+                w = g == 3 ? 10 : g == 2 ? 7 : 4;
+                for (v = 0, k -= g; g; g--)
+                    v = (v << 3) + (v << 1) + (*p++ - '0');
+            } else if (mode == 2) { // up to 2 characters in 11 bits
+                v = qr_alnum[*p++];
+                w = 6;
+                if (--k) {
+                    v = (v << 5) + (v << 3) + (v << 2) + v + qr_alnum[*p++];
+                    w = 11;
+                    k--;
+                }
+            } else {
+                v = *p++;
+                w = 8;
+                k--;
+            }
+            for (acc = acc << w | v, n += w; n >= 8; n -= 8)
+                buf[i++] = acc >> (n - 8);
+        }
     }
 
-    /* Clear out the rest bytes for ECC; also clear 1 extra byte for the spare
-     * bits (v2 & v3 have 7 unused).
+    /* Terminator (4 zero bits) and zeros up to the byte boundary. */
+    acc <<= 4;
+    n += 4;
+    for (; n >= 8; n -= 8)
+        buf[i++] = acc >> (n - 8);
+    if (n)
+        buf[i++] = acc << (8 - n);
+    return i;
+}
+
+/*
+ * Prepare all the data bits before ECC. buf must be word aligned.
+ */
+static void _serialize_data(qr_ctx *ctx, uint32_t *buf)
+{
+    uint e = _count_ext(ctx);
+    uint i = ctx->len + 2 + e; // first pad codeword in byte mode
+    if (ctx->nseg)
+        i = _serialize_segs(ctx, (uint8_t *) buf);
+    else if (ctx->iov)
+        _serialize_iov(ctx, (uint8_t *) buf);
+    else
+        _serialize_words(ctx->data, ctx->len, e, buf);
+
+    /* Byte padding EC, 11, EC, ... from codeword i, a word at a time from the
+     * pattern of matching phase. The ECC area is left to _reed_solomon.
      */
-    while (i <= para->capa)
-        buf[i++] = 0;
+    const qr_params *para = ctx->params;
+    uint end = para->data;
+    uint32_t pat = i & 1 ? 0xEC11EC11 : 0x11EC11EC;
+    uint32_t keep = (1u << ((i & 3) << 3)) - 1; // codewords before i
+    uint k = i >> 2;
+    buf[k] = (buf[k] & keep) | (pat & ~keep);
+    for (k++; k << 2 < end; k++)
+        buf[k] = pat;
 }
 
-// #if defined(QR_OPT)
-#if QR_OPT == 0
 /*
- * The GF(2^8, 285) finite field element multiplication.
- * Basic iterative, unrolled, and log/exp LUT versions are implemented.
+ * The GF(2^8, 285) finite field element multiplication, log/exp LUT version.
+ * The other backends (iterative C, RV32I asm, Zbc, x86 pshufb) are in
+ * qr_gf*.c.
  * table: https://www.thonky.com/qr-code-tutorial/log-antilog-table
  */
-static inline uint _rs_mul(uint x, uint y)
-{
-    static const uint8_t _luts[2][256] = {
-        // Log table.
-        {0,   0,   1,   25,  2,   50,  26,  198, 3,   223, 51,  238, 27,  104,
-         199, 75,  4,   100, 224, 14,  52,  141, 239, 129, 28,  193, 105, 248,
-         200, 8,   76,  113, 5,   138, 101, 47,  225, 36,  15,  33,  53,  147,
-         142, 218, 240, 18,  130, 69,  29,  181, 194, 125, 106, 39,  249, 185,
-         201, 154, 9,   120, 77,  228, 114, 166, 6,   191, 139, 98,  102, 221,
-         48,  253, 226, 152, 37,  179, 16,  145, 34,  136, 54,  208, 148, 206,
-         143, 150, 219, 189, 241, 210, 19,  92,  131, 56,  70,  64,  30,  66,
-         182, 163, 195, 72,  126, 110, 107, 58,  40,  84,  250, 133, 186, 61,
-         202, 94,  155, 159, 10,  21,  121, 43,  78,  212, 229, 172, 115, 243,
-         167, 87,  7,   112, 192, 247, 140, 128, 99,  13,  103, 74,  222, 237,
-         49,  197, 254, 24,  227, 165, 153, 119, 38,  184, 180, 124, 17,  68,
-         146, 217, 35,  32,  137, 46,  55,  63,  209, 91,  149, 188, 207, 205,
-         144, 135, 151, 178, 220, 252, 190, 97,  242, 86,  211, 171, 20,  42,
-         93,  158, 132, 60,  57,  83,  71,  109, 65,  162, 31,  45,  67,  216,
-         183, 123, 164, 118, 196, 23,  73,  236, 127, 12,  111, 246, 108, 161,
-         59,  82,  41,  157, 85,  170, 251, 96,  134, 177, 187, 204, 62,  90,
-         203, 89,  95,  176, 156, 169, 160, 81,  11,  245, 22,  235, 122, 117,
-         44,  215, 79,  174, 213, 233, 230, 231, 173, 232, 116, 214, 244, 234,
-         168, 80,  88,  175},
-        // Exponential table.
-        {1,   2,   4,   8,   16,  32,  64,  128, 29,  58,  116, 232, 205, 135,
-         19,  38,  76,  152, 45,  90,  180, 117, 234, 201, 143, 3,   6,   12,
-         24,  48,  96,  192, 157, 39,  78,  156, 37,  74,  148, 53,  106, 212,
-         181, 119, 238, 193, 159, 35,  70,  140, 5,   10,  20,  40,  80,  160,
-         93,  186, 105, 210, 185, 111, 222, 161, 95,  190, 97,  194, 153, 47,
-         94,  188, 101, 202, 137, 15,  30,  60,  120, 240, 253, 231, 211, 187,
-         107, 214, 177, 127, 254, 225, 223, 163, 91,  182, 113, 226, 217, 175,
-         67,  134, 17,  34,  68,  136, 13,  26,  52,  104, 208, 189, 103, 206,
-         129, 31,  62,  124, 248, 237, 199, 147, 59,  118, 236, 197, 151, 51,
-         102, 204, 133, 23,  46,  92,  184, 109, 218, 169, 79,  158, 33,  66,
-         132, 21,  42,  84,  168, 77,  154, 41,  82,  164, 85,  170, 73,  146,
-         57,  114, 228, 213, 183, 115, 230, 209, 191, 99,  198, 145, 63,  126,
-         252, 229, 215, 179, 123, 246, 241, 255, 227, 219, 171, 75,  150, 49,
-         98,  196, 149, 55,  110, 220, 165, 87,  174, 65,  130, 25,  50,  100,
-         200, 141, 7,   14,  28,  56,  112, 224, 221, 167, 83,  166, 81,  162,
-         89,  178, 121, 242, 249, 239, 195, 155, 43,  86,  172, 69,  138, 9,
-         18,  36,  72,  144, 61,  122, 244, 245, 247, 243, 251, 235, 203, 139,
-         11,  22,  44,  88,  176, 125, 250, 233, 207, 131, 27,  54,  108, 216,
-         173, 71,  142, 1},
-    };
-    /*
-    GF field multiplication flow: 
-        x = 2^a
-        y = 2^b
-        x*y = 2^a * 2^b = 2^(a+b)%255 = 2^c
-        After calculating exponent, get the integer mode by use antilog_table, which is _luts[1][c].
-    */
-    if (!x || !y)
-        return 0;
-    uint xp = _luts[0][x] + _luts[0][y]; // exponent addition: log(x) + log(y)
+static const uint8_t _luts[2][256] = {
+    // Log table.
+    {0,   0,   1,   25,  2,   50,  26,  198, 3,   223, 51,  238, 27,  104,
+     199, 75,  4,   100, 224, 14,  52,  141, 239, 129, 28,  193, 105, 248,
+     200, 8,   76,  113, 5,   138, 101, 47,  225, 36,  15,  33,  53,  147,
+     142, 218, 240, 18,  130, 69,  29,  181, 194, 125, 106, 39,  249, 185,
+     201, 154, 9,   120, 77,  228, 114, 166, 6,   191, 139, 98,  102, 221,
+     48,  253, 226, 152, 37,  179, 16,  145, 34,  136, 54,  208, 148, 206,
+     143, 150, 219, 189, 241, 210, 19,  92,  131, 56,  70,  64,  30,  66,
+     182, 163, 195, 72,  126, 110, 107, 58,  40,  84,  250, 133, 186, 61,
+     202, 94,  155, 159, 10,  21,  121, 43,  78,  212, 229, 172, 115, 243,
+     167, 87,  7,   112, 192, 247, 140, 128, 99,  13,  103, 74,  222, 237,
+     49,  197, 254, 24,  227, 165, 153, 119, 38,  184, 180, 124, 17,  68,
+     146, 217, 35,  32,  137, 46,  55,  63,  209, 91,  149, 188, 207, 205,
+     144, 135, 151, 178, 220, 252, 190, 97,  242, 86,  211, 171, 20,  42,
+     93,  158, 132, 60,  57,  83,  71,  109, 65,  162, 31,  45,  67,  216,
+     183, 123, 164, 118, 196, 23,  73,  236, 127, 12,  111, 246, 108, 161,
+     59,  82,  41,  157, 85,  170, 251, 96,  134, 177, 187, 204, 62,  90,
+     203, 89,  95,  176, 156, 169, 160, 81,  11,  245, 22,  235, 122, 117,
+     44,  215, 79,  174, 213, 233, 230, 231, 173, 232, 116, 214, 244, 234,
+     168, 80,  88,  175},
+    // Exponential table.
+    {1,   2,   4,   8,   16,  32,  64,  128, 29,  58,  116, 232, 205, 135,
+     19,  38,  76,  152, 45,  90,  180, 117, 234, 201, 143, 3,   6,   12,
+     24,  48,  96,  192, 157, 39,  78,  156, 37,  74,  148, 53,  106, 212,
+     181, 119, 238, 193, 159, 35,  70,  140, 5,   10,  20,  40,  80,  160,
+     93,  186, 105, 210, 185, 111, 222, 161, 95,  190, 97,  194, 153, 47,
+     94,  188, 101, 202, 137, 15,  30,  60,  120, 240, 253, 231, 211, 187,
+     107, 214, 177, 127, 254, 225, 223, 163, 91,  182, 113, 226, 217, 175,
+     67,  134, 17,  34,  68,  136, 13,  26,  52,  104, 208, 189, 103, 206,
+     129, 31,  62,  124, 248, 237, 199, 147, 59,  118, 236, 197, 151, 51,
+     102, 204, 133, 23,  46,  92,  184, 109, 218, 169, 79,  158, 33,  66,
+     132, 21,  42,  84,  168, 77,  154, 41,  82,  164, 85,  170, 73,  146,
+     57,  114, 228, 213, 183, 115, 230, 209, 191, 99,  198, 145, 63,  126,
+     252, 229, 215, 179, 123, 246, 241, 255, 227, 219, 171, 75,  150, 49,
+     98,  196, 149, 55,  110, 220, 165, 87,  174, 65,  130, 25,  50,  100,
+     200, 141, 7,   14,  28,  56,  112, 224, 221, 167, 83,  166, 81,  162,
+     89,  178, 121, 242, 249, 239, 195, 155, 43,  86,  172, 69,  138, 9,
+     18,  36,  72,  144, 61,  122, 244, 245, 247, 243, 251, 235, 203, 139,
+     11,  22,  44,  88,  176, 125, 250, 233, 207, 131, 27,  54,  108, 216,
+     173, 71,  142, 1},
+};
+
+/*
+GF field multiplication flow: 
+    x = 2^a
+    y = 2^b
+    x*y = 2^a * 2^b = 2^(a+b)%255 = 2^c
+    After calculating exponent, get the integer mode by use antilog_table, which is _luts[1][c].
+The generator coefficients are stored as logs already (qr_params.gen), and
+the RS loop converts the factor once, so a product is one add and one lookup.
+*/
+static inline uint _rs_term(uint g_log, uint f_log)
+{
+    uint xp = g_log + f_log; // exponent addition: log(x) + log(y)
     if (xp > 255)
         xp -= 255;
     return _luts[1][xp];
 }
 
-#else /* use iterative GF MUL */
-static inline uint _rs_mul(uint x, uint y)
+#define QR_RS_NAME qr_rs_lut
+#define QR_RS_TERM(g, f) _rs_term(g, f)
+#define QR_RS_FACTOR(f) _luts[0][f]
+#include "qr_rs.h"
+
+static const qr_gf_backend _gf_backends[] = {
+    {"LUT", qr_rs_lut, true},
+    {"C iterative", qr_rs_iter, false},
+#ifdef __riscv
+    {"asm v1", qr_rs_asm_v1, false},
+    {"asm v2", qr_rs_asm_v2, false},
+#endif
+#if QR_GF_ZBC
+    {"Zbc clmul", qr_rs_clmul, false},
+#endif
+#if QR_GF_X86
+    {"x86 pshufb", qr_rs_x86, true},
+#endif
+};
+#define QR_GF_NBACKENDS (sizeof(_gf_backends) / sizeof(_gf_backends[0]))
+
+#if QR_GF_X86
+/* Host tools default to the pshufb one, which is LUT on CPUs without SSSE3. */
+static const qr_gf_backend *_gf = &_gf_backends[QR_GF_NBACKENDS - 1];
+#else
+static const qr_gf_backend *_gf = _gf_backends;
+#endif
+
+/*
+ * Select the GF multiply backend of the RS stage of qr_encode (0 is the LUT
+ * one, the default except in the host tools) and return its name. Return
+ * NULL and keep the current backend if id is past the last one. The other
+ * encoding paths (qr_encode_lowmem, qr_update, qr_encode_many) do not depend
+ * on it.
+ */
+const char *qr_gf_select(uint id)
 {
-    uint z = 0;
-    /* This is called (133, 340, 825) times in V(1, 2, 3) ECC calculation. */
-    for (int i = 7; i >= 0; i--) {
-        /* And this body is run 1064, 2720, 6600 times. */
-        z = (z << 1) ^ ((z >> 7) * 0x11D);
-        z ^= ((y >> i) & 1) * x;
-    }
-    return z;
+    if (id >= QR_GF_NBACKENDS)
+        return NULL;
+    _gf = &_gf_backends[id];
+    return _gf->name;
 }
-#endif
 
 /*
- * Calculate the ECC bytes.
+ * Calculate the ECC bytes with the selected backend, one call per RS block.
+ * The data codewords are in block order, and the ECC of block b goes to
+ * buf + data + b * eccdeg (see qr_params).
  */
 static void _reed_solomon(qr_ctx *ctx, uint8_t *buf)
 {
-    qr_params *para = (qr_params *) ctx->params;
-    uint deg = para->eccdeg;
-    uint8_t *gen = para->gen;
-    uint len = para->capa - para->eccdeg;
-    uint8_t *res = buf + len; // residual
-    for (uint i = 0; i < len; i++) {
-        uint factor = buf[i] ^ res[0];
-        for (uint j = 1; j < deg; j++)
-            res[j - 1] = res[j];
-        res[deg - 1] = 0;
-        for (uint j = 0; j < deg; j++)
-            res[j] ^= _rs_mul(gen[j], factor);
+    const qr_params *para = ctx->params;
+    const uint8_t *gen = _gf->log_gen ? para->gen : para->gen_val;
+    uint8_t *ecc = buf + para->data;
+    uint len = para->dlen;
+
+    for (uint b = 0; b < para->nblk; b++, ecc += para->eccdeg) {
+        if (b == para->nshort)
+            len++;
+        _gf->rs(gen, para->eccdeg, buf, len, ecc);
+        buf += len;
     }
 }
 
 /*
- * Return if dot (x,y) is for data (i.e. not function patterns).
+ * Return data codeword i of a symbol straight from its payload.
+ *
+ * Same bytes as _serialize_data writes: the nibble stream is the mode (4),
+ * the length, the data, then the terminator, followed by EC/11 padding.
+ * 8-bit count only (up to V9).
  */
-static inline bool _is_data(uint x, uint y, uint size_m1)
+static uint _data_codeword(const qr_ctx *ctx, uint i)
 {
-    if (x == 6 || y == 6)
-        return false;
-    if (y <= 8)
-        return x >= 9 && x <= size_m1 - 8;
-    if (y >= size_m1 - 7 && x <= 8)
-        return false;
-    if (size_m1 > 20 && x >= size_m1 - 8 && x <= size_m1 - 4 &&
-        y >= size_m1 - 8 && y <= size_m1 - 4)
-        return false;
-    return true;
+    uint len = ctx->len;
+    if (i > len + 1)
+        return (i - len) & 1 ? 0x11 : 0xEC;
+    uint hi = i == 0 ? 4 : i == 1 ? len : _data_byte(ctx, i - 2);
+    uint lo = i == 0 ? len : i <= len ? _data_byte(ctx, i - 1) : 0;
+    return (hi << 4 | lo >> 4) & 0xFF;
 }
 
-typedef union poly64_t {
-    uint64_t bits;
-    uint32_t u[2];
-    struct {
-        uint32_t u0;
-        uint32_t u1;
-    };
-} poly64_t;
-
 /*
- * The QR zig-zag sequence generator.
+ * Bit-sliced ECC for up to 32 symbols of the same single-block version.
+ *
+ * Bit l of every word belongs to symbol ctx[l], and a GF(2^8) element is 8
+ * such words, one per bit. A product by a constant generator coefficient is
+ * the XOR of factor * alpha^k over its set bits k, and multiplying by alpha
+ * is a rotation of the 8 words plus 3 XORs (0x11D). So the whole pass runs
+ * on AND/XOR/shift, with no LUT and no multiply.
  *
- * To iterate through all valid data positions: call with initial x and y =
- * size-1, feed back the result as input, and repeat the call-feed cycle.
+ * res[j][k] receives bit k of ECC byte j for all lanes.
  */
-static uint64_t zigzag_step(uint x, uint y, uint size_m1)
+static void _reed_solomon_x32(const qr_ctx *ctx, uint n, uint32_t res[][8])
 {
-    poly64_t r;
-    while (true) {
-        switch ((x - (x > 6)) & 3) {
-        case 0:
-            if (y < size_m1)
-                x += 1, y += 1;
-            else
-                x -= 1;
-            break;
-        case 1:
-            x -= 1;
-            break;
-        case 2:
-            if (y > 0)
-                x += 1, y -= 1;
-            else {
-                x -= 1;
-                if (x == 6)
-                    x = 5;
+    const qr_params *para = ctx->params;
+    uint deg = para->eccdeg;
+    uint len = para->data;
+    const uint8_t *gen = para->gen_val;
+    uint32_t ring[QR_ECC_L_MAX][8];
+    uint32_t fa[8][8]; // factor * alpha^k
+    uint h = 0;
+
+    for (uint j = 0; j < deg; j++) {
+        for (uint k = 0; k < 8; k++)
+            ring[j][k] = 0;
+    }
+
+    for (uint i = 0; i < len; i++) {
+        uint32_t *f = fa[0];
+        for (uint k = 0; k < 8; k++) {
+            f[k] = ring[h][k];
+            ring[h][k] = 0;
+        }
+        if (++h == deg)
+            h = 0;
+
+        /* Transpose codeword i of every lane into the bit planes. */
+        for (uint l = 0; l < n; l++) {
+            uint c = _data_codeword(ctx + l, i);
+            for (uint k = 0; k < 8; k++)
+                f[k] ^= (c >> k & 1) << l;
+        }
+        if (!(f[0] | f[1] | f[2] | f[3] | f[4] | f[5] | f[6] | f[7]))
+            continue;
+
+        for (uint k = 1; k < 8; k++) {
+            const uint32_t *p = fa[k - 1];
+            uint32_t *q = fa[k];
+            q[0] = p[7];
+            q[1] = p[0];
+            q[2] = p[1] ^ p[7];
+            q[3] = p[2] ^ p[7];
+            q[4] = p[3] ^ p[7];
+            q[5] = p[4];
+            q[6] = p[5];
+            q[7] = p[6];
+        }
+
+        uint r = h;
+        for (uint j = 0; j < deg; j++) {
+            uint32_t *t = ring[r];
+            for (uint c = gen[j], k = 0; c; c >>= 1, k++) {
+                if (!(c & 1))
+                    continue;
+                for (uint b = 0; b < 8; b++)
+                    t[b] ^= fa[k][b];
             }
-            break;
-        default:
-            x -= 1;
+            if (++r == deg)
+                r = 0;
         }
-        if (_is_data(x, y, size_m1))
-            break;
     }
-    r.u0 = x, r.u1 = y;
-    return r.bits;
+
+    /* Unroll the ring, leading term first. */
+    for (uint j = 0; j < deg; j++) {
+        for (uint k = 0; k < 8; k++)
+            res[j][k] = ring[h][k];
+        if (++h == deg)
+            h = 0;
+    }
 }
 
 /*
- * Put data bits to the QR bitmap.
- * Fixed masking (0) is applied on the fly.
+ * Put data bits to the QR bitmap, one codeword per step.
+ *
+ * Codewords are taken in symbol order: buf[i], or buf[perm[i]] through the
+ * interleave table of a version with several RS blocks, so the placement
+ * itself stays a linear walk. Each one is bit-reversed into an LSB-first
+ * stream, then handed out to the build-time placement runs (qr_tables.c),
+ * 1 or 2 bits per row OR. The data is left unmasked; see _mask_data.
  */
 static void _place_data(qr_ctx *ctx, const uint8_t *buf)
 {
-    uint size_m1 = ctx->size - 1;
-    poly64_t xy = {.u0 = size_m1, .u1 = size_m1}; // store the current coordinate where this buf bit data should put
-    qr_params *para = (qr_params *) ctx->params;
-    uint nbits = para->capa * 8;
+    const qr_run *run = qr_runs[(ctx->size - 21) >> 2]; // 21, 25, ... -> 0, 1, ...
+    const qr_params *para = ctx->params;
+    const uint16_t *perm = para->perm;
+    qr_row *A = ctx->bmp;
+    uint32_t bits = 0; // pending stream bits, next one at bit 0
+    uint avail = 0;
+
+    for (uint i = 0; i < para->capa; i++) {
+        bits |= (uint32_t) qr_rev8[buf[perm ? perm[i] : i]] << avail;
+        avail += 8;
+        while (avail >= run->n) {
+            A[run->y] |= (qr_row) (bits & run->mask) << run->shift;
+            bits >>= run->n;
+            avail -= run->n;
+            run++;
+        }
+    }
+}
+
+/* Format data of level ecl (QR_ECL_*) with mask m; see qr_format. */
+#define QR_FORMAT(ecl, m) (((ecl) ^ 1) << 3 | (m))
+
+/*
+ * Stamp format word d (qr_format index) into both format areas, which the
+ * template leaves light: one OR for row 8, then column 8 row by row, all
+ * from the build-time masks.
+ */
+static void _put_format(qr_row A[], uint size, uint d)
+{
+    uint col = qr_format_col[d];
+
+    A[8] |= qr_format_row[(size - 21) >> 2][d];
+    for (uint b = 0; b < 16; b++)
+        if (col >> b & 1)
+            A[b < 9 ? b : size - 16 + b] |= QR_COL(8);
+}
+
+/*
+ * Write A = src with data mask m and its format bits applied; src is a
+ * bitmap of ctx.
+ */
+static void _apply_mask(qr_row A[], const qr_row src[], const qr_ctx *ctx,
+                        uint m)
+{
+    uint size = ctx->size;
+    const qr_row *dmask = qr_datamask[(size - 21) >> 2];
+    const qr_row *pat = qr_maskpat[m];
+    uint k = 0; // y % 12
+    for (uint y = 0; y < size; y++) {
+        A[y] = src[y] ^ (pat[k] & dmask[y]);
+        if (++k == 12)
+            k = 0;
+    }
+    _put_format(A, size, QR_FORMAT(ctx->params->ecl, m));
+}
+
+static inline uint _popcount(uint32_t x)
+{
+    x -= (x >> 1) & 0x55555555;
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    x += x >> 8;
+    x += x >> 16;
+    return x & 0x3F;
+}
+
+static inline uint _popcount_row(qr_row x)
+{
+#if QR_ROW_BITS == 64
+    return _popcount(x) + _popcount(x >> 32);
+#else
+    return _popcount(x);
+#endif
+}
+
+/* For the N3 match sets, almost always empty: one step per set bit. */
+static inline uint _popcount_sparse(qr_row x)
+{
+    uint n = 0;
+    for (; x; x &= x - 1)
+        n++;
+    return n;
+}
+
+/*
+ * Rule N1 from a set of 5-module windows w: a run of L >= 5 modules gives
+ * L - 4 windows and costs 3 + (L - 5), i.e. one per window plus 2 per run.
+ * Runs are counted by the window that has no window right before it.
+ */
+static inline uint _n1(qr_row w, qr_row prev)
+{
+    return _popcount_row(w) + (_popcount_row(w & ~prev) << 1);
+}
+
+/*
+ * Rule N3 at the window starting at each bit: 1011101 with 4 light modules
+ * after (10111010000) or before (00001011101) it. D(k) and L(k) give the
+ * dark and light modules k steps further along the line.
+ */
+#define _N3(D, L)                                  \
+    (L(1) & D(4) & L(5) & D(6) & L(9) &            \
+     ((D(0) & D(2) & D(3) & L(7) & L(8) & L(10)) | \
+      (L(0) & L(2) & L(3) & D(7) & D(8) & D(10))))
+#define _ROW_D(k) (d << (k))
+#define _ROW_L(k) (l << (k))
+#define _COL_D(k) (A[y + (k)])
+#define _COL_L(k) (L[y + (k)])
+
+/* N1 + 3 * N2 + 40 * N3, in shifts (no M extension). */
+#define _N123(n1, n2, n3) ((n1) + ((n2) << 1) + (n2) + ((n3) << 5) + ((n3) << 3))
+
+/*
+ * ISO 18004 penalty score of a masked symbol, rules N1-N4.
+ *
+ * Everything runs on whole row words: horizontal rules shift a row against
+ * itself, and vertical rules AND neighbouring rows, where each bit lane is a
+ * column. So the columns need no transposed copy.
+ *
+ * Every rule only adds, so scoring stops once the partial sum reaches bound
+ * (the best score so far) and returns that partial sum, which cannot win.
+ */
+static uint _penalty(const qr_row A[], uint size, uint bound)
+{
+    qr_row L[QR_LINES]; // light modules
+    qr_row vm = ~(qr_row) 0 << (QR_ROW_BITS - size);
+    qr_row w, pw, t;
+    uint n1 = 0, n2 = 0, n3 = 0, dark = 0;
+    uint y;
+
+    for (y = 0; y < size; y++)
+        L[y] = ~A[y] & vm;
+
+    for (y = 0; y < size; y++) {
+        qr_row d = A[y], l = L[y];
+        dark += _popcount_row(d);
+
+        /* N1 in the row: w bit p means modules p..p-4 share the colour.
+         * A dark and a light window never overlap, so the two sets are
+         * counted as one, here and in N2 and the column N1 below. */
+        t = d & d << 1;
+        t &= t << 2;
+        w = t & d << 4;
+        t = l & l << 1;
+        t &= t << 2;
+        w |= t & l << 4;
+        n1 += _n1(w, w << 1);
+
+        /* N3 in the row. */
+        n3 += _popcount_sparse(_N3(_ROW_D, _ROW_L));
+
+        if (y + 1 == size)
+            break;
+        /* N2: 2x2 blocks of one colour. */
+        t = d & A[y + 1];
+        w = t & t << 1;
+        t = l & L[y + 1];
+        n2 += _popcount_row(w | (t & t << 1));
+        if (_N123(n1, n2, n3) >= bound)
+            return _N123(n1, n2, n3);
+    }
+
+    /* N1 in the columns: 5 rows ANDed, runs start where the row above had no
+     * window. */
+    pw = 0;
+    for (y = 0; y + 5 <= size; y++) {
+        w = (A[y] & A[y + 1] & A[y + 2] & A[y + 3] & A[y + 4]) |
+            (L[y] & L[y + 1] & L[y + 2] & L[y + 3] & L[y + 4]);
+        n1 += _n1(w, pw);
+        pw = w;
+    }
+    if (_N123(n1, n2, n3) >= bound)
+        return _N123(n1, n2, n3);
+
+    /* N3 in the columns. */
+    for (y = 0; y + 11 <= size; y++)
+        n3 += _popcount_sparse(_N3(_COL_D, _COL_L));
+
+    /* N4: 10 points per full 5% of dark modules away from 50%, i.e.
+     * floor(|20 * dark - 10 * total| / total). No divide: subtract. */
+    uint total = 0; // size * size, by adds
+    for (y = 0; y < size; y++)
+        total += size;
+    uint hi = (dark << 4) + (dark << 2), lo = (total << 3) + (total << 1);
+    uint diff = hi > lo ? hi - lo : lo - hi;
+    uint k = 0;
+    for (; diff >= total; diff -= total)
+        k++;
+
+    return _N123(n1, n2, n3) + (k << 3) + (k << 1);
+}
 
-    /* NB: count in the unused bits in V2 and V3. */
-    if (size_m1 > 20)
-        nbits += 7;
+/*
+ * Evaluate all 8 masks and apply the one with the lowest penalty (the
+ * lowest mask number on ties). Each mask is scored only until it reaches
+ * the best score so far.
+ */
+static void _mask_data(qr_ctx *ctx)
+{
+    qr_row T[QR_LINES];
+    uint best = 0, best_score = ~0u;
 
-    for (int i = 0; i < nbits; i++) {
-        bool mask0 = (xy.u0 + xy.u1) % 2 == 0;
-        bool dot = buf[i / 8] & (0x80u >> i % 8);
-        if (dot ^ mask0) // switch the bit
-            ctx->bmp[xy.u1] |= 0x80000000u >> xy.u0;
-        xy.bits = zigzag_step(xy.u0, xy.u1, size_m1);
+    for (uint m = 0; m < 8; m++) {
+        _apply_mask(T, ctx->bmp, ctx, m);
+        uint score = _penalty(T, ctx->size, best_score);
+        if (score < best_score)
+            best_score = score, best = m;
     }
+    _apply_mask(ctx->bmp, ctx->bmp, ctx, best);
+    ctx->mask = best;
 }
 
 /*
@@ -409,48 +998,1465 @@ void qr_encode(qr_ctx *ctx)
     if (!ctx)
         return;
 
-    uint8_t dbuf[72];  // V3 capacity 70 and extra 2.
+    uint32_t dbuf[QR_CW_WORDS]; // capacity and extra 2.
     _serialize_data(ctx, dbuf);
-    _reed_solomon(ctx, dbuf);
-    _place_data(ctx, dbuf);
+    _reed_solomon(ctx, (uint8_t *) dbuf);
+    _place_data(ctx, (uint8_t *) dbuf);
+    _mask_data(ctx);
 }
 
-void dump_bmp(qr_ctx *ctx)
+/*
+ * Encode without the codeword buffer, for targets short on stack.
+ *
+ * Each data codeword is made from the payload as in _serialize_iov, fed to
+ * the RS residual and placed right away; the ECC is then placed straight
+ * from the residual. Only the residual (at most QR_ECC_MAX bytes) and the
+ * pending placement bits are kept. The symbol is the same as with qr_encode.
+ * Mixed-mode payloads (qr_eval_auto) and versions with several RS blocks
+ * (V6 and up), whose codewords are placed interleaved, take the buffered
+ * qr_encode path.
+ */
+void qr_encode_lowmem(qr_ctx *ctx)
 {
-    for (int i = 0; i < ctx->size + 2; i++)
-        TEST_LOGGER("██");
-    TEST_LOGGER("\n");
+    if (!ctx)
+        return;
+    if (ctx->nseg || ctx->params->nblk > 1) {
+        qr_encode(ctx);
+        return;
+    }
 
-    for (int y = 0; y < ctx->size; y++) {
-        TEST_LOGGER("██");
-        for (int x = 0; x < ctx->size; x++)
-            if (qr_getdot(ctx, x, y))
-            {
-                TEST_LOGGER("  "); // black
+    const qr_params *para = ctx->params;
+    uint deg = para->eccdeg;
+    const uint8_t *gen = para->gen;
+    uint len = para->data;
+    const qr_run *run = qr_runs[(ctx->size - 21) >> 2];
+    qr_row *A = ctx->bmp;
+    uint8_t ring[QR_ECC_MAX];
+    uint h = 0; // ring[h] is the leading residual term
+    uint32_t bits = 0; // pending stream bits, next one at bit 0
+    uint avail = 0;
+    const uint8_t *data = ctx->data; // NULL for fragments
+    uint n = ctx->len;
+    uint b = 4 << 8 | n; // byte mode
+    uint pad = 0xEC;
+
+    for (uint j = 0; j < deg; j++)
+        ring[j] = 0;
+
+    for (uint i = 0; i < para->capa; i++) {
+        uint c;
+        if (i < len) {
+            if (i == 0) {
+                c = b >> 4;
+            } else if (i <= n) {
+                b = b << 8 | (data ? data[i - 1] : _data_byte(ctx, i - 1));
+                c = b >> 4 & 0xFF;
+            } else if (i == n + 1) {
+                c = b << 4 & 0xFF; // final 4 bits with terminator
+            } else {
+                c = pad;
+                pad ^= 0xFD; /* alternating EC, 11. */
             }
-            else
-            {
-                TEST_LOGGER("██"); // white
+            uint factor = c ^ ring[h];
+            ring[h] = 0;
+            if (++h == deg)
+                h = 0;
+            if (factor) {
+                factor = _luts[0][factor];
+                uint k = h;
+                for (uint j = 0; j < deg; j++) {
+                    ring[k] ^= _rs_term(gen[j], factor);
+                    if (++k == deg)
+                        k = 0;
+                }
             }
-        TEST_LOGGER("██\n");
+        } else {
+            c = ring[h]; // ECC, leading term first
+            if (++h == deg)
+                h = 0;
+        }
+
+        bits |= (uint32_t) qr_rev8[c] << avail;
+        avail += 8;
+        while (avail >= run->n) {
+            A[run->y] |= (qr_row) (bits & run->mask) << run->shift;
+            bits >>= run->n;
+            avail -= run->n;
+            run++;
+        }
     }
-    for (int i = 0; i < ctx->size + 2; i++)
-        TEST_LOGGER("██");
-    TEST_LOGGER("\n");
+    _mask_data(ctx);
 }
 
-int generate_qrcode(void)
+/*
+ * Encode n symbols at once.
+ *
+ * The contexts are meant to be evaluated in byte mode (qr_eval or
+ * qr_eval_iov) for the same version and level. ECC is then computed 32
+ * symbols at a time by the bit-sliced encoder, and each symbol gets its
+ * codewords serialized and placed as in qr_encode. Otherwise (a mixed-mode
+ * context from qr_eval_auto, mixed versions or levels), and for levels other
+ * than L or versions with several RS blocks (V6 and up), the symbols are
+ * encoded one by one with qr_encode.
+ */
+void qr_encode_many(qr_ctx ctx[], uint n)
 {
-    qr_ctx ctx[1];
-    const char *str = "https://github.com/sysprog21/rv32emu";
-    // const char *str = "ffffffffffffffffffffffffffffffffff";
-    // const char *str = "https://www.youtube.com/watch?v=x1v2tX4_dkQ";
+    if (!ctx || !n)
+        return;
+
+    const qr_params *para = ctx->params;
+    uint deg = para->eccdeg;
+    uint8_t *res;
+    uint32_t dbuf[QR_CW_WORDS];
+    uint32_t ecc[QR_ECC_L_MAX][8];
+
+    bool sliced = para->nblk == 1 && para->ecl == QR_ECL_L;
+    for (uint i = 0; i < n && sliced; i++)
+        sliced = !ctx[i].nseg && ctx[i].params == para;
+    if (!sliced) {
+        for (uint i = 0; i < n; i++)
+            qr_encode(ctx + i);
+        return;
+    }
+
+    for (uint base = 0; base < n; base += QR_LANES) {
+        uint m = n - base < QR_LANES ? n - base : QR_LANES;
+        _reed_solomon_x32(ctx + base, m, ecc);
+        for (uint l = 0; l < m; l++) {
+            qr_ctx *c = ctx + base + l;
+            _serialize_data(c, dbuf);
+            /* Pull lane l out of the bit planes. */
+            res = (uint8_t *) dbuf + para->data;
+            for (uint j = 0; j < deg; j++) {
+                uint v = 0;
+                for (uint k = 0; k < 8; k++)
+                    v |= (ecc[j][k] >> l & 1) << k;
+                res[j] = v;
+            }
+            _place_data(c, (uint8_t *) dbuf);
+            _mask_data(c);
+        }
+    }
+}
+
+/*
+ * XOR codeword delta c into codeword i of the bitmap, through the same
+ * placement runs as _place_data (qr_cwrun gives the run it starts at).
+ */
+static void _xor_codeword(qr_ctx *ctx, uint i, uint c)
+{
+    uint v = (ctx->size - 21) >> 2;
+    uint e = qr_cwrun[v][i];
+    const qr_run *run = qr_runs[v] + (e >> 1);
+    qr_row *A = ctx->bmp;
+    uint32_t bits = (uint32_t) qr_rev8[c] << (e & 1);
+
+    for (int avail = 8 + (e & 1); avail > 0; avail -= run->n, run++) {
+        A[run->y] ^= (qr_row) (bits & run->mask) << run->shift;
+        bits >>= run->n;
+    }
+}
+
+/*
+ * Replace payload bytes [offset, offset + n) of an encoded symbol with
+ * new_bytes, without encoding it again.
+ *
+ * Serialization, RS and placement are all linear over XOR, so only the delta
+ * has to be applied: payload byte k feeds codewords k + 1 and k + 2, and a
+ * delta d in data codeword i changes the ECC by d times the ECC of a unit
+ * codeword there (qr_eccunit). Just those codewords and the ECC are XORed
+ * into the masked bitmap. The mask is kept: the symbol stays valid, but its
+ * penalty may no longer be the lowest.
+ *
+ * The old bytes are read from the payload, which is not written; copy
+ * new_bytes into it afterwards if the context will be updated again.
+ * Return false if the range is outside the payload, for a mixed-mode
+ * payload (qr_eval_auto), or past V3 or at another level than L (no
+ * qr_eccunit tables).
+ */
+bool qr_update(qr_ctx *ctx, uint offset, const uint8_t *new_bytes, uint n)
+{
+    if (!ctx || ctx->nseg || ctx->size > 29 ||
+        ctx->params->ecl != QR_ECL_L || offset > ctx->len ||
+        n > ctx->len - offset)
+        return false;
+
+    const qr_params *para = ctx->params;
+    uint deg = para->eccdeg;
+    const uint8_t(*unit)[16] = qr_eccunit[(ctx->size - 21) >> 2];
+    uint8_t ecc[QR_ECC_MAX];
+    uint prev = 0; // delta of the previous payload byte
+
+    for (uint j = 0; j < deg; j++)
+        ecc[j] = 0;
+
+    for (uint k = 0; k <= n; k++) {
+        uint d = k < n ? _data_byte(ctx, offset + k) ^ new_bytes[k] : 0;
+        uint c = (prev << 4 | d >> 4) & 0xFF; // codeword offset + 1 + k
+        uint i = offset + 1 + k;
+        prev = d;
+        if (!c)
+            continue;
+        _xor_codeword(ctx, i, c);
+        uint f = _luts[0][c];
+        for (uint j = 0; j < deg; j++) {
+            uint u = unit[i][j];
+            if (!u)
+                continue;
+            u = _luts[0][u];
+            ecc[j] ^= _rs_term(u, f);
+        }
+    }
+
+    uint len = para->data;
+    for (uint j = 0; j < deg; j++)
+        if (ecc[j])
+            _xor_codeword(ctx, len + j, ecc[j]);
+    return true;
+}
+
+typedef struct qr_payload {
+    const uint8_t *data;
+    uint len;
+} qr_payload;
+
+/*
+ * Encode n payloads as symbols of the same version into out[0..n-1].
+ *
+ * Every symbol starts from a copy of the version template, then goes through
+ * serialization, bit-sliced ECC and placement (qr_encode_many).
+ * Return false, with nothing encoded, if the version is invalid or any
+ * payload exceeds its capacity.
+ */
+bool qr_encode_batch(const qr_payload payloads[], uint n, uint ver,
+                     qr_ctx out[])
+{
+    for (uint i = 0; i < n; i++)
+        if (!qr_eval(out + i, ver, payloads[i].data, payloads[i].len))
+            return false;
+    qr_encode_many(out, n);
+    return true;
+}
+
+/* One encoded symbol in a qr_cache. */
+typedef struct qr_cache_entry {
+    uint32_t hash; // 0 if the slot is empty
+    uint32_t used; // cache tick of the last fill or hit
+    uint8_t size;
+    uint8_t nseg;  // 0 for byte mode, else the segment count (qr_eval_auto)
+    uint8_t ecl;
+    uint8_t mask;
+    uint16_t len;
+    uint8_t key[QR_CHARS_MAX]; // payload
+    qr_row bmp[QR_LINES];
+} qr_cache_entry;
+
+/*
+ * Symbols already encoded, for qr_encode_cached. Zero-initialize before use.
+ * Open addressing: a payload goes in one of the QR_CACHE_WAYS slots after its
+ * hash slot, evicting the least recently used one of them when all are full.
+ *
+ * A slot holds a whole payload (QR_CHARS_MAX bytes) and bitmap: 260 bytes
+ * at VER_MAX=3 and 1128 at VER_MAX=10, so the default 64 slots take about
+ * 16 KB and 70 KB. Build with -DQR_CACHE_SLOTS=n to size it for the target.
+ */
+typedef struct qr_cache {
+    uint32_t tick;
+    uint32_t hits;
+    uint32_t misses;
+    qr_cache_entry slot[QR_CACHE_SLOTS];
+} qr_cache;
+
+/*
+ * Hash of the symbol parameters and payload: h * 33 ^ byte (shift and add,
+ * no multiply), never 0.
+ */
+static uint32_t _cache_hash(const qr_ctx *ctx)
+{
+    uint32_t h = 5381 ^ ctx->size ^ (uint32_t) ctx->nseg << 8 ^
+                 (uint32_t) ctx->params->ecl << 16;
+    for (uint k = 0; k < ctx->len; k++)
+        h = ((h << 5) + h) ^ _data_byte(ctx, k);
+    return h ? h : 1;
+}
+
+static bool _cache_match(const qr_cache_entry *e, const qr_ctx *ctx,
+                         uint32_t h)
+{
+    if (e->hash != h || e->size != ctx->size || e->nseg != ctx->nseg ||
+        e->ecl != ctx->params->ecl || e->len != ctx->len)
+        return false;
+    for (uint k = 0; k < ctx->len; k++)
+        if (e->key[k] != _data_byte(ctx, k))
+            return false;
+    return true;
+}
+
+/*
+ * Same as qr_encode, through a cache of encoded symbols: on a hit the stored
+ * bitmap and mask are copied into ctx, with no serialization, RS, placement
+ * or mask scoring. The key is the version, the level, the mode (byte or
+ * qr_eval_auto) and the payload bytes, compared in full on a hash match.
+ */
+void qr_encode_cached(qr_cache *cache, qr_ctx *ctx)
+{
+    if (!ctx)
+        return;
+    if (!cache) {
+        qr_encode(ctx);
+        return;
+    }
+
+    uint32_t h = _cache_hash(ctx);
+    uint first = h & (QR_CACHE_SLOTS - 1);
+    qr_cache_entry *victim = NULL;
+    cache->tick++;
+
+    for (uint w = 0; w < QR_CACHE_WAYS; w++) {
+        qr_cache_entry *e = &cache->slot[(first + w) & (QR_CACHE_SLOTS - 1)];
+        if (_cache_match(e, ctx, h)) {
+            e->used = cache->tick;
+            ctx->mask = e->mask;
+            for (uint y = 0; y < ctx->size; y++)
+                ctx->bmp[y] = e->bmp[y];
+            cache->hits++;
+            return;
+        }
+        if (!victim || (victim->hash && (!e->hash || e->used < victim->used)))
+            victim = e;
+    }
 
-    if (!qr_eval(ctx, /* version */ 3, (const uint8_t *) str, str_len(str))) {
-        TEST_LOGGER("Evaluation failed. Version invalid or data too long?\n");
-        return -2;
-    }
     qr_encode(ctx);
+    cache->misses++;
+    victim->hash = h;
+    victim->used = cache->tick;
+    victim->size = ctx->size;
+    victim->nseg = ctx->nseg;
+    victim->ecl = ctx->params->ecl;
+    victim->len = ctx->len;
+    victim->mask = ctx->mask;
+    for (uint k = 0; k < ctx->len; k++)
+        victim->key[k] = _data_byte(ctx, k);
+    for (uint y = 0; y < ctx->size; y++)
+        victim->bmp[y] = ctx->bmp[y];
+}
+
+/*
+ * Load built-in symbol id (QR_STATIC_<name>, see qr_static.def) into ctx as
+ * qr_eval and qr_encode would leave it. The bitmap was rendered at build
+ * time: a row copy, nothing to encode. Return false if id is out of range
+ * or its entry is empty (ver 0, as in the gen_static build itself).
+ */
+bool qr_load_static(qr_ctx *ctx, uint id)
+{
+    if (!ctx || id >= QR_NSTATIC)
+        return false;
+    const qr_static *s = &qr_static_l[id];
+    if (!s->ver)
+        return false;
+    ctx->data = s->data;
+    ctx->iov = NULL;
+    ctx->nseg = 0;
+    ctx->len = s->len;
+    ctx->params = &qr_params_ecl[QR_ECL_L][s->ver - 1];
+    ctx->size = (s->ver << 2) + 17;
+    ctx->mask = s->mask;
+    for (uint y = 0; y < ctx->size; y++)
+        ctx->bmp[y] = s->bmp[y];
+    return true;
+}
+
+/*
+ * Same as qr_encode, but a byte-mode payload of qr_static.def at its version
+ * and level L gets its build-time bitmap; only the other payloads are encoded.
+ */
+void qr_encode_static(qr_ctx *ctx)
+{
+    if (!ctx)
+        return;
+    for (uint i = 0; i < QR_NSTATIC && !ctx->nseg; i++) {
+        const qr_static *s = &qr_static_l[i];
+        if (s->len != ctx->len || ctx->size != (s->ver << 2) + 17 ||
+            ctx->params->ecl != QR_ECL_L)
+            continue;
+        uint k = 0;
+        while (k < s->len && s->data[k] == _data_byte(ctx, k))
+            k++;
+        if (k == s->len) {
+            ctx->mask = s->mask;
+            for (uint y = 0; y < ctx->size; y++)
+                ctx->bmp[y] = s->bmp[y];
+            return;
+        }
+    }
+    qr_encode(ctx);
+}
+
+/* What qr_decode read from a symbol besides the payload. */
+typedef struct qr_info {
+    uint8_t ecl;  // error correction level (QR_ECL_*)
+    uint8_t mask; // data mask (0-7)
+    uint16_t len; // payload length
+} qr_info;
+
+/* Alphanumeric mode characters by value (the inverse of qr_alnum). */
+static const char _alnum_set[] =
+    "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+/*
+ * Read n (at most 16) bits of a codeword buffer, first bit at *pos, MSB
+ * first. Two bytes past the last one read must be readable.
+ */
+static inline uint _get_bits(const uint8_t *buf, uint *pos, uint n)
+{
+    const uint8_t *b = buf + (*pos >> 3);
+    uint32_t w = (uint32_t) b[0] << 16 | (uint32_t) b[1] << 8 | b[2];
+    uint s = 24 - (*pos & 7) - n;
+    *pos += n;
+    return w >> s & ((1u << n) - 1);
+}
+
+/* Write the g (1-3) decimal digits of v < 10^g, by subtraction (no divide). */
+static uint8_t *_put_digits(uint8_t *out, uint v, uint g)
+{
+    uint h = 0, t = 0;
+    for (; v >= 100; v -= 100)
+        h++;
+    for (; v >= 10; v -= 10)
+        t++;
+    if (g == 3)
+        *out++ = '0' + h;
+    if (g >= 2)
+        *out++ = '0' + t;
+    *out++ = '0' + v;
+    return out;
+}
+
+/*
+ * Read the segments of the data codewords up to the terminator (or the end of
+ * the nbits data bits) into out. Return the payload length, or -1 if a mode,
+ * count or character value is invalid.
+ */
+static int _read_segs(const uint8_t *buf, uint nbits, bool wide, uint8_t *out)
+{
+    static const uint16_t _lim[4] = {0, 10, 100, 1000};
+    uint8_t *p = out;
+    uint pos = 0;
+
+    while (pos + 4 <= nbits) {
+        uint mode = _get_bits(buf, &pos, 4);
+        if (!mode)
+            break;
+        if (mode != 1 && mode != 2 && mode != 4)
+            return -1;
+        uint cbits = _count_bits(mode, wide);
+        if (pos + cbits > nbits)
+            return -1;
+        uint k = _get_bits(buf, &pos, cbits);
+        if (k > QR_CHARS_MAX - (uint) (p - out) ||
+            pos + _seg_bits(mode, k, wide) - 4 - cbits > nbits)
+            return -1;
+
+        if (mode == 4) {
+            for (; k; k--)
+                *p++ = _get_bits(buf, &pos, 8);
+        } else if (mode == 2) {
+            for (; k >= 2; k -= 2) {
+                uint v = _get_bits(buf, &pos, 11), q = 0;
+                if (v >= 2025) // 45 * 45
+                    return -1;
+                for (; v >= 45; v -= 45)
+                    q++;
+                *p++ = _alnum_set[q];
+                *p++ = _alnum_set[v];
+            }
+            if (k) {
+                uint v = _get_bits(buf, &pos, 6);
+                if (v >= 45)
+                    return -1;
+                *p++ = _alnum_set[v];
+            }
+        } else {
+            while (k) {
+                uint g = k < 3 ? k : 3;
+                uint v = _get_bits(buf, &pos, g == 3 ? 10 : g == 2 ? 7 : 4);
+                if (v >= _lim[g])
+                    return -1;
+                p = _put_digits(p, v, g);
+                k -= g;
+            }
+        }
+    }
+    return p - out;
+}
+
+/*
+ * Decode a symbol straight from its packed rows, as qr_encode leaves them: a
+ * clean, axis-aligned symbol of size modules, nothing else in the row words.
+ *
+ * Row 8 is looked up among the 32 format words (qr_format_row), which gives
+ * the level and the mask, and every module outside the data area must then
+ * match the template with that format stamped in. The data modules are
+ * unmasked a row word at a time and read back through the placement runs,
+ * each codeword going to its block-order slot through the interleave
+ * permutation: _place_data backwards. Each RS block gets its ECC recomputed
+ * on the selected GF backend and compared, which is the same test as all
+ * syndromes being 0, then the segments are read (numeric, alphanumeric and
+ * byte, as characters).
+ *
+ * Return false if any of it fails. Else out (QR_CHARS_MAX bytes) holds the
+ * payload and info its length, level and mask.
+ */
+bool qr_decode(const qr_row bmp[], uint size, uint8_t *out, qr_info *info)
+{
+    uint32_t dbuf[QR_CW_WORDS];
+    uint8_t *buf = (uint8_t *) dbuf;
+    uint8_t chk[QR_ECC_MAX];
+    qr_row T[QR_LINES];
+
+    if (!bmp || !out || !info || size < 21 || size > QR_LINES ||
+        (size - 21) & 3)
+        return false;
+    uint v = (size - 21) >> 2;
+
+    /* Format word of row 8, among the 32 of this version. */
+    const qr_row *frow = qr_format_row[v];
+    qr_row area = 0;
+    uint d;
+    for (d = 0; d < 32; d++)
+        area |= frow[d];
+    for (d = 0; d < 32 && (bmp[8] & area) != frow[d]; d++)
+        ;
+    if (d == 32)
+        return false;
+    const qr_params *para = &qr_params_ecl[(d >> 3) ^ 1][v];
+
+    /* Function patterns and format against the template, and unmask. */
+    const qr_row *tmpl = qr_template[v];
+    const qr_row *dmask = qr_datamask[v];
+    const qr_row *pat = qr_maskpat[d & 7];
+    for (uint y = 0; y < size; y++)
+        T[y] = tmpl[y];
+    _put_format(T, size, d);
+    for (uint y = 0, k = 0; y < size; y++) {
+        if ((bmp[y] ^ T[y]) & ~dmask[y])
+            return false;
+        T[y] = bmp[y] ^ (pat[k] & dmask[y]);
+        if (++k == 12)
+            k = 0;
+    }
+
+    /* Codewords back from the placement runs, in block order. */
+    const qr_run *run = qr_runs[v];
+    const uint16_t *perm = para->perm;
+    uint32_t bits = 0; // stream bits not yet taken, next one at bit 0
+    uint avail = 0;
+    for (uint i = 0; i < para->capa; i++) {
+        while (avail < 8) {
+            bits |= (uint32_t) (T[run->y] >> run->shift & run->mask) << avail;
+            avail += run->n;
+            run++;
+        }
+        buf[perm ? perm[i] : i] = qr_rev8[bits & 0xFF];
+        bits >>= 8;
+        avail -= 8;
+    }
+
+    /* ECC of each block. */
+    const uint8_t *gen = _gf->log_gen ? para->gen : para->gen_val;
+    const uint8_t *p = buf, *ecc = buf + para->data;
+    uint len = para->dlen;
+    for (uint b = 0; b < para->nblk; b++, ecc += para->eccdeg) {
+        if (b == para->nshort)
+            len++;
+        _gf->rs(gen, para->eccdeg, p, len, chk);
+        for (uint j = 0; j < para->eccdeg; j++)
+            if (chk[j] != ecc[j])
+                return false;
+        p += len;
+    }
+
+    int n = _read_segs(buf, (uint) para->data << 3, size >= 57, out);
+    if (n < 0)
+        return false;
+    info->ecl = para->ecl;
+    info->mask = d & 7;
+    info->len = n;
+    return true;
+}
+
+/*
+ * Decode the bitmap of an encoded ctx (qr_decode) and check it against the
+ * context: level, mask and payload. Cheap enough to validate every symbol of
+ * a bulk run.
+ */
+bool qr_verify(const qr_ctx *ctx)
+{
+    uint8_t out[QR_CHARS_MAX];
+    qr_info info;
+
+    if (!ctx || !qr_decode(ctx->bmp, ctx->size, out, &info) ||
+        info.ecl != ctx->params->ecl || info.mask != ctx->mask ||
+        info.len != ctx->len)
+        return false;
+    for (uint k = 0; k < info.len; k++)
+        if (out[k] != _data_byte(ctx, k))
+            return false;
+    return true;
+}
+
+/*
+ * Append the k (1-32) low bits of v to a row of pixel words: *cur holds the
+ * word being filled, with *used bits taken from the MSB down.
+ */
+static inline void _put_bits(uint32_t **out, uint32_t *cur, uint *used,
+                             uint32_t v, uint k)
+{
+    uint room = 32 - *used;
+    if (k < room) {
+        *cur |= v << (room - k);
+        *used += k;
+        return;
+    }
+    uint rest = k - room; // bits for the next word
+    *(*out)++ = *cur | v >> rest;
+    *cur = rest ? v << (32 - rest) : 0;
+    *used = rest;
+}
+
+/*
+ * Draw the symbol into a 1bpp framebuffer at integer scale (1-8).
+ *
+ * fb uses the same layout as the bitmap rows (see qr_getdot): stride words
+ * per pixel row, pixel x at bit 31 - x % 32 of word x / 32. Dark modules set
+ * pixels, light ones clear them. (x0, y0) is the top-left pixel of the
+ * symbol, and pixels outside the symbol area are left untouched (no border).
+ *
+ * Each module row is expanded once, a nibble at a time, through qr_expand,
+ * then stored to its scale pixel rows as whole words.
+ * Return false if scale is out of range or the symbol would run past the
+ * right edge of a row (x0 + size * scale > stride * 32). The caller must
+ * make sure fb has the y0 + size * scale pixel rows the symbol covers.
+ */
+bool qr_blit(qr_ctx *ctx, uint32_t *fb, uint stride, uint scale, uint x0,
+             uint y0)
+{
+    if (!ctx || scale < 1 || scale > 8)
+        return false;
+
+    const uint32_t *expand = qr_expand[scale - 1];
+    uint size = ctx->size;
+    uint width = 0; // size * scale, without a multiply
+    for (uint i = 0; i < scale; i++)
+        width += size;
+    if (x0 + width > stride << 5)
+        return false;
+    uint x1 = x0 + width - 1; // last pixel column
+    uint first = x0 >> 5, last = x1 >> 5;
+    uint32_t head = ~0u >> (x0 & 31);        // symbol bits of fb[first]
+    uint32_t tail = ~0u << (31 - (x1 & 31)); // symbol bits of fb[last]
+    if (first == last)
+        head &= tail;
+    uint32_t line[(QR_LINES * 8 + 31) / 32 + 1];
+    uint32_t *row = fb;
+    for (uint i = 0; i < y0; i++)
+        row += stride;
+
+    for (uint y = 0; y < size; y++) {
+        /* Expand the module row into pixel words, starting at bit x0 % 32. */
+        uint32_t *out = line, cur = 0;
+        qr_row w = ctx->bmp[y];
+        uint used = x0 & 31;
+        uint left = size;
+        for (; left >= 4; left -= 4, w <<= 4)
+            _put_bits(&out, &cur, &used, expand[w >> (QR_ROW_BITS - 4)],
+                      scale << 2);
+        if (left) {
+            uint k = 0;
+            for (uint i = 0; i < scale; i++)
+                k += left;
+            _put_bits(&out, &cur, &used,
+                      expand[w >> (QR_ROW_BITS - 4)] >> ((scale << 2) - k), k);
+        }
+        if (used)
+            *out = cur;
+
+        /* Store it to `scale` pixel rows. */
+        for (uint r = 0; r < scale; r++, row += stride) {
+            uint32_t *dst = row + first;
+            if (first == last) {
+                *dst = (*dst & ~head) | line[0];
+                continue;
+            }
+            *dst = (*dst & ~head) | line[0];
+            for (uint i = 1; i < last - first; i++)
+                dst[i] = line[i];
+            dst[last - first] = (dst[last - first] & ~tail) | line[last - first];
+        }
+    }
+    return true;
+}
+
+/*
+ * Row y of the symbol with a 1-module light border: column 0 and rows 0 and
+ * size + 1 are the border, and bits past the symbol are already 0.
+ */
+static inline qr_row _border_row(const qr_ctx *ctx, uint y)
+{
+    return y >= 1 && y <= ctx->size ? ctx->bmp[y - 1] >> 1 : 0;
+}
+
+/*
+ * Render the symbol and its border into out[], return the byte count.
+ * Light modules are drawn, dark ones are left blank.
+ * half: two module rows per text line, ▀ (top light), ▄ (bottom light),
+ * █ (both light) or a space; about half the bytes of the full mode.
+ */
+static uint _render_bmp(const qr_ctx *ctx, char *out, bool half)
+{
+    static const char *const _half[4] = {" ", "▄", "▀", "█"};
+    uint n = ctx->size + 2;
+    char *p = out;
+
+    for (uint y = 0; y < n; y += half ? 2 : 1) {
+        qr_row top = _border_row(ctx, y);
+        qr_row bot = half ? _border_row(ctx, y + 1) : 0;
+        for (uint x = 0; x < n; x++, top <<= 1, bot <<= 1) {
+            uint t = top >> (QR_ROW_BITS - 1), b = bot >> (QR_ROW_BITS - 1);
+            const char *g;
+            if (half)
+                g = _half[(t ^ 1) << 1 | (b ^ 1)];
+            else
+                g = t ? "  " : "██"; // black : white
+            while (*g)
+                *p++ = *g++;
+        }
+        *p++ = '\n';
+    }
+    return p - out;
+}
+
+/*
+ * Print the symbol with a single write ecall.
+ */
+void dump_bmp(qr_ctx *ctx)
+{
+    static char buf[QR_DUMP_MAX];
+    uint len = _render_bmp(ctx, buf, QR_DUMP_HALF);
+    printstr(buf, len);
+}
+
+int generate_qrcode(void)
+{
+    qr_ctx ctx[1];
+    const char *str = "https://github.com/sysprog21/rv32emu";
+    // const char *str = "ffffffffffffffffffffffffffffffffff";
+    // const char *str = "https://www.youtube.com/watch?v=x1v2tX4_dkQ";
+
+    if (!qr_eval(ctx, /* version */ 3, (const uint8_t *) str, str_len(str))) {
+        TEST_LOGGER("Evaluation failed. Version invalid or data too long?\n");
+        return -2;
+    }
+    qr_encode_static(ctx); // no encoding if listed in qr_static.def
     dump_bmp(ctx);
     return 0;
-}
\ No newline at end of file
+}
+
+/*
+ * Encode 32 variants of the URL one by one (LUT ECC) and as one batch
+ * (qr_encode_batch, bit-sliced ECC), check that both agree, and report the
+ * cycles per symbol of each. Then check that qr_encode_many falls back to
+ * qr_encode for a mixed-mode context and one of another version.
+ */
+int generate_qrcode_batch(void)
+{
+    static char str[QR_LANES][48];
+    static qr_ctx batch[QR_LANES];
+    qr_payload payloads[QR_LANES];
+    qr_ctx ctx[1];
+    uint64_t t0, t1, t2;
+
+    for (uint i = 0; i < QR_LANES; i++) {
+        sprintf(str[i], "https://github.com/sysprog21/rv32emu/%d", i);
+        payloads[i].data = (const uint8_t *) str[i];
+        payloads[i].len = str_len(str[i]);
+    }
+
+    t0 = get_cycles();
+    for (uint i = 0; i < QR_LANES; i++) {
+        if (!qr_eval(ctx, 3, (const uint8_t *) str[i], str_len(str[i])))
+            return -2;
+        qr_encode(ctx);
+    }
+    t1 = get_cycles();
+    if (!qr_encode_batch(payloads, QR_LANES, 3, batch))
+        return -2;
+    t2 = get_cycles();
+
+    for (uint i = 0; i < QR_LANES; i++) {
+        qr_eval(ctx, 3, (const uint8_t *) str[i], str_len(str[i]));
+        qr_encode(ctx);
+        for (uint y = 0; y < ctx->size; y++)
+            if (ctx->bmp[y] != batch[i].bmp[y])
+                return -3;
+    }
+
+    /* A mixed-mode context and one of another version: no bit slicing. */
+    const char *num = "01234567890123456789";
+    if (!qr_eval_auto(&batch[0], (const uint8_t *) num, str_len(num)) ||
+        !qr_eval(&batch[1], 1, (const uint8_t *) str[1], 17))
+        return -2;
+    qr_encode_many(batch, QR_LANES);
+    for (uint i = 0; i < 2; i++) {
+        if (i)
+            qr_eval(ctx, 1, (const uint8_t *) str[1], 17);
+        else
+            qr_eval_auto(ctx, (const uint8_t *) num, str_len(num));
+        qr_encode(ctx);
+        for (uint y = 0; y < ctx->size; y++)
+            if (ctx->bmp[y] != batch[i].bmp[y])
+                return -3;
+    }
+
+    /* >> 5 is / QR_LANES; no 64-bit division on bare metal. */
+    TEST_LOGGER("  Single (LUT ECC) cycles/symbol: ");
+    print_dec((unsigned long) ((t1 - t0) >> 5));
+    TEST_LOGGER("  Batch (bit-sliced ECC) cycles/symbol: ");
+    print_dec((unsigned long) ((t2 - t1) >> 5));
+    return 0;
+}
+
+/*
+ * Time the 8 mask evaluations (apply + penalty) of the URL symbol, each
+ * scored in full and then as _mask_data scores them, cut off at the best
+ * score so far; report the cycles per mask of both and the mask that wins.
+ */
+int generate_qrcode_mask_cost(void)
+{
+    qr_ctx ctx[1];
+    uint32_t dbuf[QR_CW_WORDS];
+    qr_row T[QR_LINES];
+    const char *str = "https://github.com/sysprog21/rv32emu";
+    uint64_t t0, t1, t2;
+
+    if (!qr_eval(ctx, 3, (const uint8_t *) str, str_len(str)))
+        return -2;
+    _serialize_data(ctx, dbuf);
+    _reed_solomon(ctx, (uint8_t *) dbuf);
+    _place_data(ctx, (uint8_t *) dbuf);
+
+    t0 = get_cycles();
+    for (uint m = 0; m < 8; m++) {
+        _apply_mask(T, ctx->bmp, ctx, m);
+        _penalty(T, ctx->size, ~0u);
+    }
+    t1 = get_cycles();
+    _mask_data(ctx);
+    t2 = get_cycles();
+
+    TEST_LOGGER("  Cycles per mask evaluation, full score: ");
+    print_dec((unsigned long) ((t1 - t0) >> 3));
+    TEST_LOGGER("  Cycles per mask evaluation, cut at the best score: ");
+    print_dec((unsigned long) ((t2 - t1) >> 3));
+    TEST_LOGGER("  Chosen mask: ");
+    print_dec(ctx->mask);
+    return 0;
+}
+
+/*
+ * Blit the URL symbol at scale 4 into a 128x128 framebuffer, check every
+ * pixel against qr_getdot and report the cycles of the blit.
+ */
+int generate_qrcode_blit(void)
+{
+    static uint32_t fb[128 * 4]; // 128 rows of 4 words
+    qr_ctx ctx[1];
+    const char *str = "https://github.com/sysprog21/rv32emu";
+    uint x0 = 6, y0 = 6;
+    uint64_t t0, t1;
+
+    if (!qr_eval(ctx, 3, (const uint8_t *) str, str_len(str)))
+        return -2;
+    qr_encode(ctx);
+
+    if (qr_blit(ctx, fb, 3, 4, x0, y0)) // 96 pixels: too narrow
+        return -4;
+    t0 = get_cycles();
+    if (!qr_blit(ctx, fb, 4, 4, x0, y0))
+        return -4;
+    t1 = get_cycles();
+
+    uint n = ctx->size << 2; // symbol pixels per side
+    for (uint y = 0; y < n; y++)
+        for (uint x = 0; x < n; x++) {
+            uint px = x0 + x;
+            bool on = fb[((y0 + y) << 2) + (px >> 5)] << (px & 31) >> 31;
+            if (on != qr_getdot(ctx, x >> 2, y >> 2))
+                return -3;
+        }
+
+    TEST_LOGGER("  Cycles for a scale-4 blit: ");
+    print_dec((unsigned long) (t1 - t0));
+    return 0;
+}
+
+/*
+ * Encode ".../rv32emu/00", then turn it into ".../rv32emu/42" with qr_update.
+ * Check it against a full encode of the new string with the same mask, and
+ * report the cycles of both.
+ */
+int generate_qrcode_update(void)
+{
+    static const char old_str[] = "https://github.com/sysprog21/rv32emu/00";
+    static const char new_str[] = "https://github.com/sysprog21/rv32emu/42";
+    uint len = sizeof(old_str) - 1;
+    qr_ctx ctx[1], ref[1];
+    uint32_t dbuf[QR_CW_WORDS];
+    uint64_t t0, t1, t2;
+
+    if (!qr_eval(ctx, 3, (const uint8_t *) old_str, len))
+        return -2;
+    qr_encode(ctx);
+
+    t0 = get_cycles();
+    qr_update(ctx, len - 2, (const uint8_t *) new_str + len - 2, 2);
+    t1 = get_cycles();
+    qr_eval(ref, 3, (const uint8_t *) new_str, len);
+    qr_encode(ref);
+    t2 = get_cycles();
+
+    /* Same symbol as a full encode, under the mask of the original. */
+    qr_eval(ref, 3, (const uint8_t *) new_str, len);
+    _serialize_data(ref, dbuf);
+    _reed_solomon(ref, (uint8_t *) dbuf);
+    _place_data(ref, (uint8_t *) dbuf);
+    _apply_mask(ref->bmp, ref->bmp, ref, ctx->mask);
+    for (uint y = 0; y < ctx->size; y++)
+        if (ctx->bmp[y] != ref->bmp[y])
+            return -3;
+
+    TEST_LOGGER("  qr_update cycles: ");
+    print_dec((unsigned long) (t1 - t0));
+    TEST_LOGGER("  Full encode cycles: ");
+    print_dec((unsigned long) (t2 - t1));
+    return 0;
+}
+
+/*
+ * Encode the URL prefix and a "/42" suffix as two fragments (qr_eval_iov)
+ * and as one string staged with memcpy, check that both agree, and report
+ * the cycles of each.
+ */
+int generate_qrcode_iov(void)
+{
+    static const char prefix[] = "https://github.com/sysprog21/rv32emu";
+    static const char suffix[] = "/42";
+    const qr_iov iov[2] = {
+        {(const uint8_t *) prefix, sizeof(prefix) - 1},
+        {(const uint8_t *) suffix, sizeof(suffix) - 1},
+    };
+    char str[sizeof(prefix) + sizeof(suffix)];
+    qr_ctx ctx[1], ref[1];
+    uint64_t t0, t1, t2;
+
+    t0 = get_cycles();
+    if (!qr_eval_iov(ctx, 3, iov, 2))
+        return -2;
+    qr_encode(ctx);
+    t1 = get_cycles();
+    memcpy(str, prefix, sizeof(prefix) - 1);
+    memcpy(str + sizeof(prefix) - 1, suffix, sizeof(suffix));
+    if (!qr_eval(ref, 3, (const uint8_t *) str, str_len(str)))
+        return -2;
+    qr_encode(ref);
+    t2 = get_cycles();
+
+    for (uint y = 0; y < ctx->size; y++)
+        if (ctx->bmp[y] != ref->bmp[y])
+            return -3;
+
+    TEST_LOGGER("  Fragments cycles: ");
+    print_dec((unsigned long) (t1 - t0));
+    TEST_LOGGER("  Staged copy cycles: ");
+    print_dec((unsigned long) (t2 - t1));
+    return 0;
+}
+
+/*
+ * Encode the URL with qr_encode and with qr_encode_lowmem, check that both
+ * agree, and report the cycles of each.
+ */
+int generate_qrcode_lowmem(void)
+{
+    qr_ctx ctx[1], ref[1];
+    const char *str = "https://github.com/sysprog21/rv32emu";
+    uint64_t t0, t1, t2;
+
+    if (!qr_eval(ctx, 3, (const uint8_t *) str, str_len(str)) ||
+        !qr_eval(ref, 3, (const uint8_t *) str, str_len(str)))
+        return -2;
+
+    t0 = get_cycles();
+    qr_encode(ref);
+    t1 = get_cycles();
+    qr_encode_lowmem(ctx);
+    t2 = get_cycles();
+
+    for (uint y = 0; y < ctx->size; y++)
+        if (ctx->bmp[y] != ref->bmp[y])
+            return -3;
+
+    TEST_LOGGER("  qr_encode cycles: ");
+    print_dec((unsigned long) (t1 - t0));
+    TEST_LOGGER("  qr_encode_lowmem cycles: ");
+    print_dec((unsigned long) (t2 - t1));
+    return 0;
+}
+
+/*
+ * Encode a numeric and an alphanumeric payload as V3 byte mode and through
+ * qr_eval_auto, and report the cycles of each and the version picked.
+ */
+int generate_qrcode_auto(void)
+{
+    static const char *const str[2] = {
+        "31415926535897932384626433832795028841971693993751",
+        "HTTPS://GITHUB.COM/SYSPROG21/RV32EMU",
+    };
+    qr_ctx ctx[1];
+    uint64_t t0, t1, t2;
+
+    for (uint i = 0; i < 2; i++) {
+        const uint8_t *data = (const uint8_t *) str[i];
+        uint len = str_len(str[i]);
+
+        t0 = get_cycles();
+        if (!qr_eval(ctx, 3, data, len))
+            return -2;
+        qr_encode(ctx);
+        t1 = get_cycles();
+        if (!qr_eval_auto(ctx, data, len))
+            return -2;
+        qr_encode(ctx);
+        t2 = get_cycles();
+
+        TEST_LOGGER("  Byte mode V3 cycles: ");
+        print_dec((unsigned long) (t1 - t0));
+        TEST_LOGGER("  Auto mode cycles: ");
+        print_dec((unsigned long) (t2 - t1));
+        TEST_LOGGER("  Auto version: ");
+        print_dec((ctx->size - 17) >> 2);
+    }
+    return 0;
+}
+
+/* Append s to p padded with spaces to w characters, return the new end. */
+static char *_put_col(char *p, const char *s, uint w, bool right)
+{
+    uint n = str_len(s);
+    for (; right && n < w; w--)
+        *p++ = ' ';
+    for (uint i = 0; i < n; i++)
+        *p++ = s[i];
+    for (; n < w; w--)
+        *p++ = ' ';
+    return p;
+}
+
+/*
+ * Print one table row with a single write: lead (already laid out, or
+ * NULL), the n numbers v[] right-aligned to the widths w[], then tail (or
+ * NULL).
+ */
+static void _print_row(const char *lead, const int v[], const uint8_t w[],
+                       uint n, const char *tail)
+{
+    char row[96], num[12];
+    char *p = row;
+
+    if (lead)
+        p = _put_col(p, lead, 0, false);
+    for (uint i = 0; i < n; i++) {
+        sprintf(num, "%d", v[i]);
+        p = _put_col(p, num, w[i], true);
+    }
+    if (tail)
+        p = _put_col(p, tail, 0, false);
+    *p++ = '\n';
+    printstr(row, p - row);
+}
+
+/* Fixed xorshift32 sequence, the same in every harness. */
+static uint32_t _xorshift32(uint32_t *r)
+{
+    *r ^= *r << 13;
+    *r ^= *r >> 17;
+    *r ^= *r << 5;
+    return *r;
+}
+
+/* Fill data[0..n) with pseudo-random bytes, the same on every call. */
+static void _fill_random(uint8_t *data, uint n)
+{
+    uint32_t r = 2463534242u;
+    for (uint i = 0; i < n; i++)
+        data[i] = _xorshift32(&r);
+}
+
+/*
+ * Encode the URL with every GF backend and print the cycles and instructions
+ * of the ECC stage alone and of the whole qr_encode, one row per backend.
+ * Every symbol must match the LUT one.
+ */
+int generate_qrcode_gf(void)
+{
+    static const uint8_t w[4] = {10, 13, 15, 16}; // column widths
+    const char *str = "https://github.com/sysprog21/rv32emu";
+    uint len = str_len(str);
+    qr_ctx ref[1], ctx[1];
+    uint32_t dbuf[QR_CW_WORDS];
+    const char *name;
+    int ret = 0;
+
+    if (!qr_eval(ref, 3, (const uint8_t *) str, len))
+        return -2;
+    qr_gf_select(0);
+    qr_encode(ref);
+
+    TEST_LOGGER("  Backend        ECC cycles  ECC instret  Encode cycles  "
+                "Encode instret\n");
+    for (uint id = 0; (name = qr_gf_select(id)); id++) {
+        uint64_t c[4], n[4];
+        char lead[20];
+        const char *tail = NULL;
+
+        qr_eval(ctx, 3, (const uint8_t *) str, len);
+        _serialize_data(ctx, dbuf);
+        c[0] = get_cycles();
+        n[0] = get_instret();
+        _reed_solomon(ctx, (uint8_t *) dbuf);
+        c[1] = get_cycles();
+        n[1] = get_instret();
+
+        qr_eval(ctx, 3, (const uint8_t *) str, len);
+        c[2] = get_cycles();
+        n[2] = get_instret();
+        qr_encode(ctx);
+        c[3] = get_cycles();
+        n[3] = get_instret();
+
+        for (uint y = 0; y < ctx->size; y++) {
+            if (ctx->bmp[y] != ref->bmp[y]) {
+                tail = "  MISMATCH";
+                ret = -3;
+                break;
+            }
+        }
+        *_put_col(_put_col(lead, "  ", 2, false), name, 15, false) = '\0';
+        int v[4] = {(int) (c[1] - c[0]), (int) (n[1] - n[0]),
+                    (int) (c[3] - c[2]), (int) (n[3] - n[2])};
+        _print_row(lead, v, w, 4, tail);
+    }
+    qr_gf_select(0);
+    return ret;
+}
+
+/* Fold a symbol into a running checksum (columns 0-31, all of V1-V3). */
+static uint32_t _bmp_sum(uint32_t sum, const qr_ctx *ctx)
+{
+    for (uint y = 0; y < ctx->size; y++)
+        sum = (sum << 1 | sum >> 31) ^
+              (uint32_t) (ctx->bmp[y] >> (QR_ROW_BITS - 32));
+    return sum ^ ctx->mask;
+}
+
+/*
+ * Encode a stream of 256 requests over 255 URLs with Zipf-like popularity,
+ * once with qr_encode and once with qr_encode_cached, check that both give
+ * the same symbols, and report the cycles per symbol and the hit count.
+ */
+int generate_qrcode_cache(void)
+{
+    static qr_cache cache;
+    static char str[255][48];
+    static uint8_t pick[256];
+    qr_ctx ctx[1];
+    uint32_t r = 2463534242u; // xorshift32 state
+    uint32_t sum0 = 0, sum1 = 0;
+    uint64_t t0, t1, t2;
+
+    for (uint i = 0; i < 255; i++)
+        sprintf(str[i], "https://github.com/sysprog21/rv32emu/%d", i);
+    /* Rank 2^e + u for e uniform in 0-7 and u uniform below 2^e, so
+     * P(rank) ~ 1 / rank (Zipf, s = 1) over ranks 1-255. */
+    for (uint i = 0; i < 256; i++) {
+        _xorshift32(&r);
+        uint e = r & 7;
+        pick[i] = ((1u << e) | (r >> 8 & ((1u << e) - 1))) - 1;
+    }
+
+    t0 = get_cycles();
+    for (uint i = 0; i < 256; i++) {
+        const char *s = str[pick[i]];
+        if (!qr_eval(ctx, 3, (const uint8_t *) s, str_len(s)))
+            return -2;
+        qr_encode(ctx);
+        sum0 = _bmp_sum(sum0, ctx);
+    }
+    t1 = get_cycles();
+    for (uint i = 0; i < 256; i++) {
+        const char *s = str[pick[i]];
+        if (!qr_eval(ctx, 3, (const uint8_t *) s, str_len(s)))
+            return -2;
+        qr_encode_cached(&cache, ctx);
+        sum1 = _bmp_sum(sum1, ctx);
+    }
+    t2 = get_cycles();
+    if (sum0 != sum1 || cache.hits + cache.misses != 256)
+        return -3;
+
+    /* >> 8 is / 256; no 64-bit division on bare metal. */
+    TEST_LOGGER("  qr_encode cycles/symbol: ");
+    print_dec((unsigned long) ((t1 - t0) >> 8));
+    TEST_LOGGER("  qr_encode_cached cycles/symbol: ");
+    print_dec((unsigned long) ((t2 - t1) >> 8));
+    TEST_LOGGER("  Hits: ");
+    print_dec(cache.hits);
+    TEST_LOGGER("  Misses: ");
+    print_dec(cache.misses);
+    return 0;
+}
+
+/*
+ * Encode a full-capacity byte-mode payload at every version built in, check
+ * that one byte more is refused, and report the cycles per symbol and per
+ * payload byte.
+ */
+int generate_qrcode_versions(void)
+{
+    static const uint8_t w[4] = {5, 7, 11, 13}; // column widths
+    static uint8_t data[QR_CHARS_MAX];
+    qr_ctx ctx[1];
+
+    _fill_random(data, QR_CHARS_MAX);
+    TEST_LOGGER("  Ver  Bytes     Cycles  Cycles/byte\n");
+    for (uint ver = 1; ver <= QR_VER_MAX; ver++) {
+        uint len = qr_params_ecl[QR_ECL_L][ver - 1].data - 2 - (ver >= 10);
+
+        if (qr_eval(ctx, ver, data, len + 1))
+            return -3;
+        uint64_t t0 = get_cycles();
+        if (!qr_eval(ctx, ver, data, len))
+            return -2;
+        qr_encode(ctx);
+        uint64_t t1 = get_cycles();
+
+        /* Cycles per byte by subtraction; no divide on RV32I. */
+        uint32_t c = t1 - t0, per = 0;
+        for (uint32_t rest = c; rest >= len; rest -= len)
+            per++;
+
+        int v[4] = {(int) ver, (int) len, (int) c, (int) per};
+        _print_row(NULL, v, w, 4, NULL);
+    }
+    return 0;
+}
+
+/*
+ * Check every symbol of qr_static.def against qr_eval + qr_encode, and one
+ * unlisted payload through qr_encode_static. Report the cycles of the
+ * qr_static.def URL with qr_encode, qr_encode_static and qr_load_static.
+ */
+int generate_qrcode_static(void)
+{
+    const char *str = "https://github.com/sysprog21/rv32emu";
+    const char *dyn = "https://github.com/sysprog21/rv32emu/pulls";
+    qr_ctx ref[1], ctx[1];
+    uint64_t t0, t1, t2, t3;
+
+    for (uint id = 0; id < QR_NSTATIC; id++) {
+        const qr_static *s = &qr_static_l[id];
+        if (!qr_eval(ref, s->ver, s->data, s->len) ||
+            !qr_load_static(ctx, id))
+            return -2;
+        qr_encode(ref);
+        if (ctx->size != ref->size || ctx->mask != ref->mask)
+            return -3;
+        for (uint y = 0; y < ref->size; y++)
+            if (ctx->bmp[y] != ref->bmp[y])
+                return -3;
+    }
+
+    qr_eval(ref, 3, (const uint8_t *) dyn, str_len(dyn));
+    qr_encode(ref);
+    qr_eval(ctx, 3, (const uint8_t *) dyn, str_len(dyn));
+    qr_encode_static(ctx);
+    for (uint y = 0; y < ref->size; y++)
+        if (ctx->bmp[y] != ref->bmp[y])
+            return -4;
+
+    t0 = get_cycles();
+    qr_eval(ctx, 3, (const uint8_t *) str, str_len(str));
+    qr_encode(ctx);
+    t1 = get_cycles();
+    qr_eval(ctx, 3, (const uint8_t *) str, str_len(str));
+    qr_encode_static(ctx);
+    t2 = get_cycles();
+    qr_load_static(ctx, QR_STATIC_repo);
+    t3 = get_cycles();
+
+    TEST_LOGGER("  Built-in symbols: ");
+    print_dec(QR_NSTATIC);
+    TEST_LOGGER("  qr_eval + qr_encode cycles: ");
+    print_dec((unsigned long) (t1 - t0));
+    TEST_LOGGER("  qr_eval + qr_encode_static cycles: ");
+    print_dec((unsigned long) (t2 - t1));
+    TEST_LOGGER("  qr_load_static cycles: ");
+    print_dec((unsigned long) (t3 - t2));
+    return 0;
+}
+
+/*
+ * Encode a full-capacity byte-mode V3 payload at each error correction level,
+ * check that one byte more is refused, and report the cycles of the RS stage
+ * alone and of the whole qr_eval_ecl + qr_encode.
+ */
+int generate_qrcode_levels(void)
+{
+    static const char *const lead[4] = {"      L", "      M", "      Q",
+                                        "      H"};
+    static const uint8_t w[4] = {7, 8, 12, 15}; // column widths
+    static uint8_t data[QR_CHARS_MAX];
+    uint32_t dbuf[QR_CW_WORDS];
+    qr_ctx ctx[1];
+
+    _fill_random(data, QR_CHARS_MAX);
+    TEST_LOGGER("  Level  Bytes  Blocks  ECC cycles  Encode cycles\n");
+    for (uint ecl = QR_ECL_L; ecl <= QR_ECL_H; ecl++) {
+        const qr_params *para = &qr_params_ecl[ecl][2];
+        uint len = para->data - 2;
+
+        if (qr_eval_ecl(ctx, 3, ecl, data, len + 1))
+            return -3;
+        qr_eval_ecl(ctx, 3, ecl, data, len);
+        _serialize_data(ctx, dbuf);
+        uint64_t t0 = get_cycles();
+        _reed_solomon(ctx, (uint8_t *) dbuf);
+        uint64_t t1 = get_cycles();
+        if (!qr_eval_ecl(ctx, 3, ecl, data, len))
+            return -2;
+        qr_encode(ctx);
+        uint64_t t2 = get_cycles();
+
+        int v[4] = {(int) len, (int) para->nblk, (int) (t1 - t0),
+                    (int) (t2 - t1)};
+        _print_row(lead[ecl], v, w, 4, NULL);
+    }
+    return 0;
+}
+
+/*
+ * Round-trip check of the decoder: encode a full-capacity byte-mode payload
+ * at every version built in and verify it, reporting the encode and verify
+ * cycles and the overhead of verifying; then a mixed-mode and a level H
+ * symbol, and bitmaps with one data module or one timing module flipped,
+ * which must be refused.
+ */
+int generate_qrcode_verify(void)
+{
+    static const char *mixed = "HTTPS://QR123.EXAMPLE/ID/0123456789?v=1";
+    static const uint8_t w[5] = {5, 7, 15, 15, 12}; // column widths
+    static uint8_t data[QR_CHARS_MAX];
+    qr_ctx ctx[1];
+
+    _fill_random(data, QR_CHARS_MAX);
+    TEST_LOGGER("  Ver  Bytes  Encode cycles  Verify cycles  Overhead %\n");
+    for (uint ver = 1; ver <= QR_VER_MAX; ver++) {
+        uint len = qr_params_ecl[QR_ECL_L][ver - 1].data - 2 - (ver >= 10);
+
+        uint64_t t0 = get_cycles();
+        qr_eval(ctx, ver, data, len);
+        qr_encode(ctx);
+        uint64_t t1 = get_cycles();
+        if (!qr_verify(ctx))
+            return -2;
+        uint64_t t2 = get_cycles();
+
+        /* 100 * verify / encode by shifts and subtraction. */
+        uint32_t e = t1 - t0, v = t2 - t1, pct = 0;
+        for (uint32_t rest = (v << 6) + (v << 5) + (v << 2); rest >= e;
+             rest -= e)
+            pct++;
+
+        int col[5] = {(int) ver, (int) len, (int) e, (int) v, (int) pct};
+        _print_row(NULL, col, w, 5, NULL);
+    }
+
+    /* Last symbol with a data module, then a timing module, flipped. */
+    ctx->bmp[ctx->size - 1] ^= QR_COL(ctx->size - 1);
+    if (qr_verify(ctx))
+        return -3;
+    ctx->bmp[ctx->size - 1] ^= QR_COL(ctx->size - 1);
+    ctx->bmp[6] ^= QR_COL(9);
+    if (qr_verify(ctx))
+        return -3;
+
+    if (!qr_eval_auto(ctx, (const uint8_t *) mixed, str_len(mixed)))
+        return -4;
+    qr_encode(ctx);
+    if (!qr_verify(ctx))
+        return -4;
+    if (!qr_eval_ecl(ctx, 3, QR_ECL_H, data, 24))
+        return -5;
+    qr_encode(ctx);
+    if (!qr_verify(ctx))
+        return -5;
+    TEST_LOGGER("  Flipped modules refused; mixed-mode, level H verified\n");
+    return 0;
+}
+
+/* Is module (x, y) of the bordered symbol light? Past the border too. */
+static bool _light(qr_ctx *ctx, uint x, uint y)
+{
+    return x < 1 || y < 1 || x > ctx->size || y > ctx->size ||
+           !qr_getdot(ctx, x - 1, y - 1);
+}
+
+/*
+ * Render the URL symbol in half-block mode, check every glyph against the
+ * module pair it stands for and the line count, then print it.
+ */
+int generate_qrcode_half(void)
+{
+    static char buf[QR_DUMP_MAX];
+    qr_ctx ctx[1];
+    const char *str = "https://github.com/sysprog21/rv32emu";
+
+    if (!qr_eval(ctx, 3, (const uint8_t *) str, str_len(str)))
+        return -2;
+    qr_encode(ctx);
+
+    uint n = ctx->size + 2, lines = 0;
+    uint len = _render_bmp(ctx, buf, true);
+    const char *p = buf;
+    for (uint y = 0; y < n; y += 2, lines++) {
+        for (uint x = 0; x < n; x++) {
+            bool t = _light(ctx, x, y), b = _light(ctx, x, y + 1);
+            const char *g = t ? (b ? "█" : "▀") : (b ? "▄" : " ");
+            while (*g)
+                if (*p++ != *g++)
+                    return -3;
+        }
+        if (*p++ != '\n')
+            return -4;
+    }
+    if (p != buf + len || lines != (n + 1) >> 1)
+        return -4;
+
+    printstr(buf, len);
+    TEST_LOGGER("  Lines: ");
+    print_dec(lines);
+    TEST_LOGGER("  Bytes: ");
+    print_dec(len);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef QRD_PROTO_H
+#define QRD_PROTO_H
+
+/*
+ * Wire format of the host encoding daemon (daemon_host.c) and its load
+ * generator (load_host.c), over a Unix stream socket.
+ *
+ * Request: a 2-byte header {op, len}, then len payload bytes for
+ * QRD_ENCODE. Every request gets one qrd_reply, in request order per
+ * connection. Fields are in host byte order, as the socket is local.
+ */
+
+#include <stdint.h>
+
+#define QRD_SOCKET "/tmp/qrd.sock"
+
+enum {
+    QRD_ENCODE = 0, // encode len payload bytes at the smallest version
+    QRD_BATCH = 1,  // set the batch size to len (1-255); no payload
+};
+
+enum {
+    QRD_OK = 0,
+    QRD_TOOLONG = 1, // payload over the V3 byte capacity (53)
+    QRD_BADREQ = 2,  // unknown op or batch size 0
+};
+
+typedef struct qrd_reply {
+    uint8_t status;
+    uint8_t ver;          // 1-3 when status is QRD_OK
+    uint8_t mask;         // data mask chosen by qr_encode
+    uint8_t len;          // payload length (QRD_BATCH: the new batch size)
+    uint32_t rows[29];    // row words, bit 31 - x is column x; rows past
+                          // the symbol size are 0
+} qrd_reply;
+
+#endif /* QRD_PROTO_H */